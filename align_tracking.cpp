@@ -0,0 +1,117 @@
+#include "align_tracking.h"
+
+#include <opencv2/imgproc.hpp>
+#include <opencv2/video/tracking.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+    /* Drift is a few pixels at most, so a small finest level is enough and
+       keeps one refinement in the low milliseconds. */
+    constexpr int kWorkWidth = 480;
+    constexpr int kMaxLevels = 3;
+    constexpr int kMinLevelSide = 64;
+    /* Phase correlation runs on every composed frame; translation survives
+       heavy downscaling far better than a full homography does. */
+    constexpr int kPhaseWidth = 320;
+
+    cv::Matx33d scaling(double s)
+    {
+        return cv::Matx33d(s, 0, 0, 0, s, 0, 0, 0, 1);
+    }
+
+    /* Gray CV_32F at the given size; any depth, one or three channels. */
+    cv::Mat phaseInput(const cv::Mat& src, const cv::Size& size)
+    {
+        cv::Mat gray;
+        if (src.channels() == 3) cv::cvtColor(src, gray, cv::COLOR_BGR2GRAY);
+        else gray = src;
+        cv::Mat small, out;
+        cv::resize(gray, small, size, 0, 0, cv::INTER_AREA);
+        small.convertTo(out, CV_32F);
+        return out;
+    }
+
+    cv::Matx33d normalized(const cv::Matx33d& H)
+    {
+        return std::abs(H(2, 2)) > 1e-12 ? H * (1.0 / H(2, 2)) : H;
+    }
+}
+
+bool refineHomographyEcc(const cv::Mat& ref, const cv::Mat& cam, cv::Matx33d& H, double& rho)
+{
+    if (ref.empty() || cam.empty()) return false;
+
+    const double sRef = std::min(1.0, static_cast<double>(kWorkWidth) / ref.cols);
+    const double sCam = std::min(1.0, static_cast<double>(kWorkWidth) / cam.cols);
+    std::vector<cv::Mat> refPyr(1), camPyr(1);
+    cv::resize(ref, refPyr[0], cv::Size(), sRef, sRef, cv::INTER_AREA);
+    cv::resize(cam, camPyr[0], cv::Size(), sCam, sCam, cv::INTER_AREA);
+    while (static_cast<int>(refPyr.size()) < kMaxLevels
+           && std::min(refPyr.back().cols, refPyr.back().rows) / 2 >= kMinLevelSide
+           && std::min(camPyr.back().cols, camPyr.back().rows) / 2 >= kMinLevelSide) {
+        cv::Mat r, c;
+        cv::pyrDown(refPyr.back(), r);
+        cv::pyrDown(camPyr.back(), c);
+        refPyr.push_back(r);
+        camPyr.push_back(c);
+    }
+
+    /* ECC warps template (reference) coordinates into input (camera)
+       coordinates, which is H^-1 at the working scale. */
+    const int levels = static_cast<int>(refPyr.size());
+    const double coarse = 1.0 / (1 << (levels - 1));
+    cv::Matx33d W = scaling(sCam * coarse) * H.inv() * scaling(1.0 / (sRef * coarse));
+
+    const cv::TermCriteria criteria(cv::TermCriteria::COUNT | cv::TermCriteria::EPS, 50, 1e-4);
+    double r = 0.0;
+    for (int l = levels - 1; l >= 0; --l) {
+        cv::Mat w32;
+        cv::Mat(normalized(W)).convertTo(w32, CV_32F);
+        r = cv::findTransformECC(refPyr[l], camPyr[l], w32, cv::MOTION_HOMOGRAPHY, criteria, cv::noArray(), 5);
+        cv::Mat w64;
+        w32.convertTo(w64, CV_64F);
+        W = cv::Matx33d(w64.ptr<double>());
+        if (l > 0) W = scaling(2.0) * W * scaling(0.5);
+    }
+
+    const cv::Matx33d refined = normalized((scaling(1.0 / sCam) * W * scaling(sRef)).inv());
+    if (!cv::checkRange(cv::Mat(refined))) return false;
+    H = refined;
+    rho = r;
+    return true;
+}
+
+double cornerDisplacement(const cv::Matx33d& a, const cv::Matx33d& b, const cv::Size& size)
+{
+    const cv::Point2d corners[] = {
+        {0.0, 0.0}, {static_cast<double>(size.width), 0.0},
+        {0.0, static_cast<double>(size.height)}, {static_cast<double>(size.width), static_cast<double>(size.height)}};
+    auto apply = [](const cv::Matx33d& H, const cv::Point2d& p) {
+        const cv::Vec3d v = H * cv::Vec3d(p.x, p.y, 1.0);
+        return std::abs(v[2]) > 1e-12 ? cv::Point2d(v[0] / v[2], v[1] / v[2]) : cv::Point2d(1e9, 1e9);
+    };
+    double worst = 0.0;
+    for (const cv::Point2d& p : corners) {
+        const cv::Point2d d = apply(a, p) - apply(b, p);
+        worst = std::max(worst, std::hypot(d.x, d.y));
+    }
+    return worst;
+}
+
+cv::Point2d phaseShift(const cv::Mat& ref, const cv::Mat& cam, cv::Mat& window, double& response)
+{
+    response = 0.0;
+    if (ref.empty() || cam.empty()) return cv::Point2d();
+
+    /* Both images go to the same working size, so a camera at a different
+       resolution is measured in reference pixels. */
+    const double s = std::min(1.0, static_cast<double>(kPhaseWidth) / ref.cols);
+    const cv::Size size(std::max(1, cvRound(ref.cols * s)), std::max(1, cvRound(ref.rows * s)));
+    if (window.size() != size) cv::createHanningWindow(window, size, CV_32F);
+
+    const cv::Point2d p = cv::phaseCorrelate(phaseInput(ref, size), phaseInput(cam, size), window, &response);
+    return cv::Point2d(p.x * ref.cols / size.width, p.y * ref.rows / size.height);
+}
@@ -0,0 +1,31 @@
+#ifndef ALIGN_TRACKING_H
+#define ALIGN_TRACKING_H
+
+#include <opencv2/core.hpp>
+
+/* One camera's refined homography and how it relates to the guess. */
+struct AlignRefinement {
+    bool ok = false;
+    cv::Matx33d H;
+    double rho = 0.0;
+    /* Corner displacement from the initial guess, reference pixels. */
+    double jump = 0.0;
+};
+
+/* Refines H, the homography taking camera pixels onto reference pixels,
+   with pyramid ECC on downscaled 8-bit grays. H is the initial guess and
+   is only written on success; rho is the final correlation. Throws
+   cv::Exception when ECC diverges. */
+bool refineHomographyEcc(const cv::Mat& ref, const cv::Mat& cam, cv::Matx33d& H, double& rho);
+
+/* Largest displacement of the four image corners between two homographies,
+   in reference pixels. */
+double cornerDisplacement(const cv::Matx33d& a, const cv::Matx33d& b, const cv::Size& size);
+
+/* Sub-pixel translation of cam relative to ref by phase correlation of
+   Hann-windowed, downscaled grays, in reference pixels: cam content sits at
+   ref content + shift. response is the normalized correlation peak (0..1).
+   window is reused between calls and rebuilt when the working size changes. */
+cv::Point2d phaseShift(const cv::Mat& ref, const cv::Mat& cam, cv::Mat& window, double& response);
+
+#endif // ALIGN_TRACKING_H
@@ -0,0 +1,240 @@
+#include "camera_discovery.h"
+#include "v4l2_capture.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileSystemWatcher>
+#include <QProcess>
+#include <QRegularExpression>
+#include <QTimer>
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <iostream>
+#include <vector>
+
+#ifndef Q_OS_LINUX
+#include <opencv2/videoio.hpp>
+#endif
+
+namespace {
+    constexpr int kListTimeoutMs = 3000;
+    constexpr int kHotplugDebounceMs = 400;
+    /* How often a running listing checks for cancellation. */
+    constexpr int kCancelPollMs = 50;
+
+    /* The listing tool is waited for in short slices so that a cancelled
+       scan kills it instead of sitting out the timeout. */
+    QStringList listLibCameras(const std::atomic<bool>& cancel)
+    {
+        QStringList cameraPaths;
+        QString output;
+        for (const QString& program : { QString("rpicam-hello"), QString("libcamera-hello") }) {
+            if (cancel) break;
+            QProcess process;
+            process.start(program, QStringList() << "--list-cameras");
+            if (!process.waitForStarted(kListTimeoutMs)) continue;
+            bool finished = false;
+            QElapsedTimer elapsed;
+            elapsed.start();
+            while (!cancel && !elapsed.hasExpired(kListTimeoutMs)) {
+                if (process.state() == QProcess::NotRunning || process.waitForFinished(kCancelPollMs)) {
+                    finished = true;
+                    break;
+                }
+            }
+            if (!finished) {
+                process.kill();
+                process.waitForFinished(500);
+                continue;
+            }
+            if (process.exitCode() != 0) continue;
+            output = process.readAllStandardOutput();
+            break;
+        }
+
+        QRegularExpression re("\\((/base/[^)]+)\\)");
+        QRegularExpressionMatchIterator i = re.globalMatch(output);
+        while (i.hasNext()) {
+            QRegularExpressionMatch match = i.next();
+            if (match.hasMatch()) cameraPaths << match.captured(1);
+        }
+        return cameraPaths;
+    }
+
+#ifdef Q_OS_LINUX
+    QString readSysfs(const QString& path)
+    {
+        QFile f(path);
+        if (!f.open(QIODevice::ReadOnly)) return {};
+        return QString::fromUtf8(f.readAll()).trimmed();
+    }
+
+    /* Walks /sys/class/video4linux and probes every primary node in parallel.
+       Secondary nodes (sysfs index != 0, e.g. UVC metadata) are skipped
+       without being opened, and once the scan is cancelled no further node
+       is. */
+    QList<CameraInfo> listV4L2Devices(const std::atomic<bool>& cancel)
+    {
+        struct Probe { bool ok = false; std::string busInfo; };
+        struct Node { int index; QString name; std::future<Probe> probe; };
+        std::vector<Node> nodes;
+
+        const QDir sys("/sys/class/video4linux");
+        for (const QString& entry : sys.entryList(QStringList() << "video*", QDir::Dirs | QDir::System)) {
+            if (cancel) break;
+            bool isNum = false;
+            const int index = entry.mid(5).toInt(&isNum);
+            if (!isNum) continue;
+            const QString idx = readSysfs(sys.filePath(entry + "/index"));
+            if (!idx.isEmpty() && idx != "0") continue;
+
+            const std::string dev = "/dev/video" + std::to_string(index);
+            nodes.push_back({ index, readSysfs(sys.filePath(entry + "/name")),
+                              std::async(std::launch::async, [dev, &cancel]() {
+                                  Probe p;
+                                  if (cancel) return p;
+                                  p.ok = V4L2Capture::probe(dev, nullptr, &p.busInfo);
+                                  return p;
+                              }) });
+        }
+
+        QList<CameraInfo> out;
+        for (Node& n : nodes) {
+            const Probe p = n.probe.get();
+            if (!p.ok) continue;
+            CameraInfo info;
+            info.kind    = CameraInfo::Kind::V4L2;
+            info.id      = QString("/dev/video%1").arg(n.index);
+            info.index   = n.index;
+            info.name    = n.name;
+            info.busInfo = QString::fromStdString(p.busInfo);
+            out << info;
+        }
+        std::sort(out.begin(), out.end(), [](const CameraInfo& a, const CameraInfo& b) { return a.index < b.index; });
+        return out;
+    }
+#else
+    QList<CameraInfo> listIndexDevices(const std::atomic<bool>& cancel)
+    {
+        QList<CameraInfo> out;
+        for (int i = 0; i < 10 && !cancel; ++i) {
+            cv::VideoCapture tmp;
+            tmp.open(i, cv::CAP_DSHOW);
+            if (!tmp.isOpened()) continue;
+            CameraInfo info;
+            info.kind  = CameraInfo::Kind::Index;
+            info.id    = QString::number(i);
+            info.index = i;
+            info.name  = QString("Camera %1").arg(i);
+            out << info;
+        }
+        return out;
+    }
+#endif
+}
+
+CameraDiscovery::CameraDiscovery(QObject* parent)
+    : QObject(parent)
+{
+    m_debounce = new QTimer(this);
+    m_debounce->setSingleShot(true);
+    m_debounce->setInterval(kHotplugDebounceMs);
+    connect(m_debounce, &QTimer::timeout, this, &CameraDiscovery::refresh);
+
+#ifdef Q_OS_LINUX
+    m_watcher = new QFileSystemWatcher(this);
+    m_watcher->addPath("/dev");
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, m_debounce, qOverload<>(&QTimer::start));
+#endif
+
+    refresh();
+}
+
+CameraDiscovery::~CameraDiscovery()
+{
+    m_cancel = true;
+    if (m_thread.joinable()) m_thread.join();
+}
+
+void CameraDiscovery::refresh()
+{
+    if (m_scanning) {
+        m_rescanQueued = true;
+        return;
+    }
+    if (m_thread.joinable()) m_thread.join();
+    m_scanning = true;
+    m_thread = std::thread([this]() {
+        QList<CameraInfo> result = scan(m_cancel);
+        if (m_cancel) return;
+        QMetaObject::invokeMethod(this, [this, result]() { onScanFinished(result); }, Qt::QueuedConnection);
+    });
+}
+
+QList<CameraInfo> CameraDiscovery::scan(const std::atomic<bool>& cancel)
+{
+    auto libcams = std::async(std::launch::async, [&cancel]() { return listLibCameras(cancel); });
+
+    QList<CameraInfo> out;
+#ifdef Q_OS_LINUX
+    QList<CameraInfo> devices = listV4L2Devices(cancel);
+#else
+    QList<CameraInfo> devices = listIndexDevices(cancel);
+#endif
+
+    for (const QString& id : libcams.get()) {
+        CameraInfo info;
+        info.kind = CameraInfo::Kind::LibCamera;
+        info.id   = id;
+        info.name = id.section('/', -1);
+        out << info;
+    }
+    out << devices;
+    return out;
+}
+
+void CameraDiscovery::onScanFinished(const QList<CameraInfo>& result)
+{
+    if (m_thread.joinable()) m_thread.join();
+    m_scanning = false;
+
+    m_cameras = result;
+    m_ready = true;
+    std::cerr << "[discovery] " << m_cameras.size() << " camera(s)" << std::endl;
+    emit camerasChanged();
+
+    if (m_rescanQueued) {
+        m_rescanQueued = false;
+        refresh();
+    }
+}
+
+QStringList CameraDiscovery::libcameraIds() const
+{
+    QStringList ids;
+    for (const CameraInfo& c : m_cameras) {
+        if (c.kind == CameraInfo::Kind::LibCamera) ids << c.id;
+    }
+    return ids;
+}
+
+QList<int> CameraDiscovery::deviceIndices() const
+{
+    QList<int> indices;
+    for (const CameraInfo& c : m_cameras) {
+        if (c.kind != CameraInfo::Kind::LibCamera) indices << c.index;
+    }
+    return indices;
+}
+
+QString CameraDiscovery::stableId(int index) const
+{
+    for (const CameraInfo& c : m_cameras) {
+        if (c.kind == CameraInfo::Kind::LibCamera || c.index != index) continue;
+        return c.busInfo.isEmpty() ? c.id : c.busInfo;
+    }
+    return QString::number(index);
+}
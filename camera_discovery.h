@@ -0,0 +1,63 @@
+#ifndef CAMERA_DISCOVERY_H
+#define CAMERA_DISCOVERY_H
+
+#include <QObject>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include <atomic>
+#include <thread>
+
+class QFileSystemWatcher;
+class QTimer;
+
+struct CameraInfo {
+    enum class Kind { LibCamera, V4L2, Index };
+    Kind kind = Kind::Index;
+    QString id;
+    int index = -1;
+    QString name;
+    QString busInfo;
+};
+
+/* Background camera enumeration. The scan (libcamera listing, sysfs walk and
+   per-node V4L2 capability probes, all in parallel) runs off the GUI thread;
+   the result is cached and camerasChanged() fires on the owner's thread.
+   On Linux /dev is watched so plugging or unplugging a camera triggers a
+   debounced rescan. Destruction cancels a scan in flight: the listing
+   process is killed, no further node is probed and only the probes
+   already running are waited for. */
+class CameraDiscovery : public QObject {
+    Q_OBJECT
+public:
+    explicit CameraDiscovery(QObject* parent = nullptr);
+    ~CameraDiscovery();
+
+    void refresh();
+    bool ready() const { return m_ready; }
+    const QList<CameraInfo>& cameras() const { return m_cameras; }
+    QStringList libcameraIds() const;
+    QList<int> deviceIndices() const;
+    /* Identifier that survives re-enumeration: the V4L2 bus info when the
+       driver reports one, otherwise the device id. */
+    QString stableId(int index) const;
+
+signals:
+    void camerasChanged();
+
+private:
+    static QList<CameraInfo> scan(const std::atomic<bool>& cancel);
+    void onScanFinished(const QList<CameraInfo>& result);
+
+    QList<CameraInfo> m_cameras;
+    bool m_ready = false;
+    bool m_scanning = false;
+    bool m_rescanQueued = false;
+    std::atomic<bool> m_cancel{false};
+    std::thread m_thread;
+    QFileSystemWatcher* m_watcher = nullptr;
+    QTimer* m_debounce = nullptr;
+};
+
+#endif // CAMERA_DISCOVERY_H
@@ -0,0 +1,357 @@
+#include "feature_align.h"
+
+#include <opencv2/calib3d.hpp>
+#include <opencv2/features2d.hpp>
+#include <opencv2/flann.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/video/tracking.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace {
+    /* Features are extracted at this width; 1080p drops to a quarter of
+       the pixels while keeping enough texture for SIFT and ORB. */
+    constexpr int kCoarseWidth = 960;
+
+    struct DetectorSpec {
+        const char* tag;
+        float loweRatio;
+        cv::Ptr<cv::Feature2D> (*detector)();
+        cv::Ptr<cv::DescriptorMatcher> (*matcher)();
+    };
+
+    const DetectorSpec kDetectors[] = {
+        {"SIFT", 0.75f,
+         []() -> cv::Ptr<cv::Feature2D> { return cv::SIFT::create(0, 3, 0.04, 10.0, 1.6); },
+         []() -> cv::Ptr<cv::DescriptorMatcher> {
+             return cv::makePtr<cv::FlannBasedMatcher>(cv::makePtr<cv::flann::KDTreeIndexParams>(5),
+                                                       cv::makePtr<cv::flann::SearchParams>(50));
+         }},
+        {"ORB", 0.75f,
+         []() -> cv::Ptr<cv::Feature2D> { return cv::ORB::create(4000); },
+         []() -> cv::Ptr<cv::DescriptorMatcher> { return cv::BFMatcher::create(cv::NORM_HAMMING, false); }},
+    };
+    constexpr int kDetectorCount = static_cast<int>(sizeof(kDetectors) / sizeof(kDetectors[0]));
+
+    struct Features {
+        std::vector<cv::KeyPoint> kp;
+        cv::Mat des;
+        std::string error;
+    };
+
+    cv::Matx33d scaling(double s)
+    {
+        return cv::Matx33d(s, 0, 0, 0, s, 0, 0, 0, 1);
+    }
+
+    bool isHomographySane(const cv::Mat& H, const cv::Size& imgSz)
+    {
+        if (H.empty() || H.rows != 3 || H.cols != 3) return false;
+        cv::Mat Hd;
+        H.convertTo(Hd, CV_64F);
+        double det = cv::determinant(Hd);
+        if (!std::isfinite(det) || std::abs(det) < 1e-4 || std::abs(det) > 1e4) return false;
+
+        std::vector<cv::Point2f> corners = {
+            {0.f, 0.f},
+            {static_cast<float>(imgSz.width - 1), 0.f},
+            {static_cast<float>(imgSz.width - 1), static_cast<float>(imgSz.height - 1)},
+            {0.f, static_cast<float>(imgSz.height - 1)}
+        };
+        std::vector<cv::Point2f> warped;
+        cv::perspectiveTransform(corners, warped, Hd);
+        for (const auto& p : warped) {
+            if (!std::isfinite(p.x) || !std::isfinite(p.y)) return false;
+            if (std::abs(p.x) > 4.0 * imgSz.width || std::abs(p.y) > 4.0 * imgSz.height) return false;
+        }
+        auto edgeLen = [](cv::Point2f a, cv::Point2f b) {
+            return std::hypot(a.x - b.x, a.y - b.y);
+        };
+        double e0 = edgeLen(warped[0], warped[1]);
+        double e1 = edgeLen(warped[1], warped[2]);
+        double e2 = edgeLen(warped[2], warped[3]);
+        double e3 = edgeLen(warped[3], warped[0]);
+        double srcE0 = imgSz.width;
+        double srcE1 = imgSz.height;
+        auto ratio = [](double a, double b) { return (a > b) ? (a / b) : (b / a); };
+        if (ratio(e0, srcE0) > 5.0 || ratio(e2, srcE0) > 5.0) return false;
+        if (ratio(e1, srcE1) > 5.0 || ratio(e3, srcE1) > 5.0) return false;
+        if (ratio(e0, e2) > 4.0 || ratio(e1, e3) > 4.0) return false;
+        return true;
+    }
+
+    std::string percent(int part, int whole)
+    {
+        return std::to_string(part) + "/" + std::to_string(whole) + " in ("
+               + std::to_string(whole > 0 ? part * 100 / whole : 0) + "%)";
+    }
+
+    /* Tracks the coarse inliers from the camera into the reference at full
+       resolution, starting from where H puts them, and re-solves H with a
+       tight threshold. Leaves H alone when too few points survive. */
+    bool refineFullRes(const cv::Mat& ref, const cv::Mat& cam, const std::vector<cv::Point2f>& camPts,
+                       cv::Mat& H, int& inliers, int& matches, std::string& note)
+    {
+        std::vector<cv::Point2f> refPts;
+        cv::perspectiveTransform(camPts, refPts, H);
+        std::vector<uchar> status;
+        std::vector<float> err;
+        cv::calcOpticalFlowPyrLK(cam, ref, camPts, refPts, status, err, cv::Size(21, 21), 2,
+                                 cv::TermCriteria(cv::TermCriteria::COUNT | cv::TermCriteria::EPS, 30, 0.01),
+                                 cv::OPTFLOW_USE_INITIAL_FLOW);
+
+        std::vector<cv::Point2f> src, dst;
+        for (size_t i = 0; i < status.size(); ++i) {
+            if (!status[i]) continue;
+            src.push_back(camPts[i]);
+            dst.push_back(refPts[i]);
+        }
+        const int tracked = static_cast<int>(src.size());
+        if (tracked < 12) {
+            note = "unrefined (" + std::to_string(tracked) + " tracked)";
+            return false;
+        }
+
+        cv::Mat mask;
+        cv::Mat refined = cv::findHomography(src, dst, cv::RANSAC, 1.5, mask, 5000, 0.999);
+        const int inlierCount = refined.empty() ? 0 : cv::countNonZero(mask);
+        if (refined.empty() || inlierCount < 10 || inlierCount * 2 < tracked || !isHomographySane(refined, ref.size())) {
+            note = "unrefined (" + percent(inlierCount, tracked) + ")";
+            return false;
+        }
+        H = refined;
+        inliers = inlierCount;
+        matches = tracked;
+        note = "full-res " + percent(inlierCount, tracked);
+        return true;
+    }
+}
+
+struct FeatureAligner::Race {
+    cv::Mat ref;
+    cv::Mat refCoarse;
+    double refScale = 1.0;
+    std::vector<cv::Mat> cams;
+    std::vector<cv::Mat> camsCoarse;
+    std::vector<double> camScales;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<AlignEstimate> results;
+    std::vector<std::string> errors;
+    std::vector<bool> decided;
+    int undecided = 0;
+    int running = 0;
+    std::atomic<bool> cancel{false};
+
+    bool isDecided(int c)
+    {
+        std::lock_guard<std::mutex> lk(mutex);
+        return decided[c];
+    }
+
+    void report(int c, AlignEstimate e)
+    {
+        std::lock_guard<std::mutex> lk(mutex);
+        if (decided[c]) return;
+        if (!e.ok) {
+            if (!errors[c].empty()) errors[c] += " | ";
+            errors[c] += e.error;
+            return;
+        }
+        results[c] = std::move(e);
+        decided[c] = true;
+        if (--undecided == 0) {
+            cancel = true;
+            changed.notify_all();
+        }
+    }
+};
+
+FeatureAligner::~FeatureAligner()
+{
+    stop();
+}
+
+bool FeatureAligner::busy() const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (!m_race) return false;
+    std::lock_guard<std::mutex> raceLk(m_race->mutex);
+    return m_race->running > 0;
+}
+
+void FeatureAligner::stop()
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (m_race) m_race->cancel = true;
+    for (std::thread& t : m_detectors) t.join();
+    m_detectors.clear();
+}
+
+std::vector<AlignEstimate> FeatureAligner::solve(const cv::Mat& ref, const std::vector<cv::Mat>& cams)
+{
+    const int n = static_cast<int>(cams.size());
+    if (busy()) {
+        std::vector<AlignEstimate> out(n);
+        for (AlignEstimate& e : out) e.error = "previous calibration still finishing";
+        return out;
+    }
+    /* Whatever is left of the last race has exited; reap its threads. */
+    stop();
+
+    auto race = std::make_shared<Race>();
+    auto coarse = [](const cv::Mat& img, cv::Mat& out) {
+        const double s = std::min(1.0, static_cast<double>(kCoarseWidth) / img.cols);
+        if (s < 1.0) cv::resize(img, out, cv::Size(), s, s, cv::INTER_AREA);
+        else out = img;
+        return s;
+    };
+    race->ref = ref;
+    race->refScale = coarse(ref, race->refCoarse);
+    race->cams = cams;
+    race->camsCoarse.resize(n);
+    race->camScales.resize(n);
+    for (int c = 0; c < n; ++c) race->camScales[c] = coarse(cams[c], race->camsCoarse[c]);
+    race->results.resize(n);
+    race->errors.resize(n);
+    race->decided.assign(n, false);
+    race->undecided = n;
+    race->running = kDetectorCount;
+
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_race = race;
+        for (int d = 0; d < kDetectorCount; ++d) m_detectors.emplace_back(&FeatureAligner::runDetector, race, d);
+    }
+
+    std::unique_lock<std::mutex> lk(race->mutex);
+    race->changed.wait(lk, [&]() { return race->undecided == 0 || race->running == 0; });
+    race->cancel = true;
+
+    std::vector<AlignEstimate> out(n);
+    for (int c = 0; c < n; ++c) {
+        if (race->decided[c]) {
+            out[c] = race->results[c];
+        } else {
+            out[c].error = race->errors[c].empty() ? "no detector finished" : race->errors[c];
+        }
+    }
+    return out;
+}
+
+void FeatureAligner::runDetector(std::shared_ptr<Race> race, int detector)
+{
+    const DetectorSpec& spec = kDetectors[detector];
+    const std::string tag = spec.tag;
+    const int n = static_cast<int>(race->cams.size());
+
+    /* Reference and cameras are extracted concurrently, each on a thread
+       of its own so detectAndCompute keeps its internal parallelism. */
+    std::vector<Features> feats(n + 1);
+    {
+        std::vector<std::thread> workers;
+        for (int i = 0; i <= n; ++i) {
+            if (i > 0 && race->isDecided(i - 1)) continue;
+            workers.emplace_back([&, i]() {
+                const cv::Mat& img = i == 0 ? race->refCoarse : race->camsCoarse[i - 1];
+                try {
+                    spec.detector()->detectAndCompute(img, cv::noArray(), feats[i].kp, feats[i].des);
+                }
+                catch (const cv::Exception& e) {
+                    feats[i].error = e.what();
+                }
+            });
+        }
+        for (std::thread& t : workers) t.join();
+    }
+    if (race->cancel) {
+        std::lock_guard<std::mutex> lk(race->mutex);
+        --race->running;
+        race->changed.notify_all();
+        return;
+    }
+
+    for (int c = 0; c < n && !race->cancel; ++c) {
+        if (race->isDecided(c)) continue;
+        AlignEstimate e;
+        const Features& f1 = feats[0];
+        const Features& f2 = feats[c + 1];
+        try {
+            if (!f1.error.empty() || !f2.error.empty()) {
+                e.error = tag + ": feature stage failed: " + (f1.error.empty() ? f2.error : f1.error);
+            } else if (f1.des.empty() || f2.des.empty() || f1.kp.size() < 16 || f2.kp.size() < 16) {
+                e.error = tag + ": insufficient keypoints";
+            } else {
+                std::vector<std::vector<cv::DMatch>> knn;
+                spec.matcher()->knnMatch(f2.des, f1.des, knn, 2);
+
+                std::vector<cv::Point2f> ptsSrc, ptsDst;
+                ptsSrc.reserve(knn.size());
+                ptsDst.reserve(knn.size());
+                for (const auto& pair : knn) {
+                    if (pair.size() < 2) continue;
+                    if (pair[0].distance < spec.loweRatio * pair[1].distance) {
+                        ptsSrc.push_back(f2.kp[pair[0].queryIdx].pt);
+                        ptsDst.push_back(f1.kp[pair[0].trainIdx].pt);
+                    }
+                }
+
+                const int good = static_cast<int>(ptsSrc.size());
+                cv::Mat inliers;
+                cv::Mat Hc;
+                if (good >= 12) Hc = cv::findHomography(ptsSrc, ptsDst, cv::RANSAC, 3.0, inliers, 5000, 0.999);
+                const int inlierCount = Hc.empty() ? 0 : cv::countNonZero(inliers);
+                const double inlierRatio = good > 0 ? static_cast<double>(inlierCount) / good : 0.0;
+
+                if (good < 12) {
+                    e.error = tag + ": only " + std::to_string(good) + " good matches";
+                } else if (Hc.empty() || inlierCount < 10 || inlierRatio < 0.30) {
+                    e.error = tag + ": " + percent(inlierCount, good);
+                } else if (!isHomographySane(Hc, race->refCoarse.size())) {
+                    e.error = tag + ": homography rejected (geometry sanity check failed — likely repetitive pattern)";
+                } else if (!race->cancel) {
+                    /* Back to full resolution: coarse points scale up, H is
+                       conjugated by the two scales, then refined by LK. */
+                    const double sCam = race->camScales[c];
+                    cv::Mat H = cv::Mat(scaling(1.0 / race->refScale) * cv::Matx33d(Hc) * scaling(sCam));
+                    std::vector<cv::Point2f> camPts;
+                    for (size_t i = 0; i < ptsSrc.size(); ++i) {
+                        if (inliers.at<uchar>(static_cast<int>(i)))
+                            camPts.push_back(ptsSrc[i] * static_cast<float>(1.0 / sCam));
+                    }
+                    std::string note;
+                    e.inliers = inlierCount;
+                    e.matches = good;
+                    refineFullRes(race->ref, race->cams[c], camPts, H, e.inliers, e.matches, note);
+                    if (!isHomographySane(H, race->ref.size())) {
+                        e.error = tag + ": homography rejected after scaling";
+                    } else {
+                        H.convertTo(e.warp, CV_32F);
+                        e.ok = true;
+                        e.model = tag + " " + percent(inlierCount, good) + ", " + note;
+                        std::cerr << "[align] " << tag << " CAM" << c + 2 << " H =\n" << H << "\n"
+                                  << "  coarse " << percent(inlierCount, good) << ", " << note
+                                  << ", img " << race->ref.cols << "x" << race->ref.rows << std::endl;
+                    }
+                }
+            }
+        }
+        catch (const cv::Exception& ex) {
+            e.ok = false;
+            e.error = tag + ": " + ex.what();
+        }
+        if (!e.ok && e.error.empty()) continue;
+        race->report(c, std::move(e));
+    }
+
+    std::lock_guard<std::mutex> lk(race->mutex);
+    --race->running;
+    race->changed.notify_all();
+}
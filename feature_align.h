@@ -0,0 +1,54 @@
+#ifndef FEATURE_ALIGN_H
+#define FEATURE_ALIGN_H
+
+#include <opencv2/core.hpp>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* One camera's homography onto the reference (CV_32F, camera -> reference
+   pixels), or the reason there is none. */
+struct AlignEstimate {
+    bool ok = false;
+    cv::Mat warp;
+    /* Inliers of the final fit out of the correspondences it was fit to. */
+    int inliers = 0;
+    int matches = 0;
+    std::string model;
+    std::string error;
+};
+
+/* Feature-based alignment of cameras onto a reference, all 8-bit gray.
+   Features of every image are extracted concurrently on a coarse level;
+   SIFT and ORB race each other and, per camera, the first homography that
+   passes the checks wins. The winner is then refined at full resolution
+   by tracking its inliers with pyramid LK. solve() returns once every
+   camera is decided. A running detectAndCompute cannot be interrupted, so
+   the loser finishes its current extraction on its own thread, skips the
+   matching stage and exits. The aligner owns those threads: busy() stays
+   true until they are done, solve() refuses a new race meanwhile, and
+   stop() (also run by the destructor) waits for them. */
+class FeatureAligner {
+public:
+    FeatureAligner() = default;
+    ~FeatureAligner();
+    FeatureAligner(const FeatureAligner&) = delete;
+    FeatureAligner& operator=(const FeatureAligner&) = delete;
+
+    std::vector<AlignEstimate> solve(const cv::Mat& ref, const std::vector<cv::Mat>& cams);
+    bool busy() const;
+    void stop();
+
+private:
+    struct Race;
+    static void runDetector(std::shared_ptr<Race> race, int detector);
+
+    mutable std::mutex m_mutex;
+    std::shared_ptr<Race> m_race;
+    std::vector<std::thread> m_detectors;
+};
+
+#endif // FEATURE_ALIGN_H
@@ -0,0 +1,215 @@
+#include "focus_metrics.h"
+#include "focus_metrics_detail.h"
+#include "pixel_depth.h"
+
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DUALCAM_FOCUS_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define DUALCAM_FOCUS_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace focus_detail {
+    inline int px(const uint8_t* p, int i) { return p[i]; }
+    inline int px(const uint16_t* p, int i) { return p[i] >> kShift16; }
+
+    template <typename T>
+    void accumulateScalar(const T* r0, const T* r1, const T* r2, int x0, int x1, FocusSums& s)
+    {
+        for (int x = x0; x < x1; ++x) {
+            const int lap = px(r0, x) + px(r2, x) + px(r1, x - 1) + px(r1, x + 1) - 4 * px(r1, x);
+            const int dx = px(r1, x + 1) - px(r1, x - 1);
+            const int gx = px(r0, x + 1) - px(r0, x - 1) + 2 * dx + px(r2, x + 1) - px(r2, x - 1);
+            const int gy = px(r2, x - 1) - px(r0, x - 1) + 2 * (px(r2, x) - px(r0, x)) + px(r2, x + 1) - px(r0, x + 1);
+            s.lap += lap;
+            s.lap2 += static_cast<int64_t>(lap) * lap;
+            s.ten += static_cast<int64_t>(gx) * gx + static_cast<int64_t>(gy) * gy;
+            s.bren += static_cast<int64_t>(dx) * dx;
+        }
+        if (x1 > x0) s.count += x1 - x0;
+    }
+
+    /* A 32-bit lane gains at most 2 * 2 * 1020^2 per step for 8-bit data and
+       2 * 2 * 4092^2 for 10-bit data; the lanes are moved to 64-bit sums
+       before either can overflow. */
+    template <typename T>
+    constexpr int flushSteps() { return sizeof(T) == 1 ? 256 : 16; }
+
+#if defined(DUALCAM_FOCUS_SSE2)
+    inline __m128i load8(const uint8_t* p)
+    {
+        return _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)), _mm_setzero_si128());
+    }
+    inline __m128i load8(const uint16_t* p)
+    {
+        return _mm_srli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), kShift16);
+    }
+
+    inline int64_t laneSum(__m128i v)
+    {
+        alignas(16) int32_t l[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(l), v);
+        return static_cast<int64_t>(l[0]) + l[1] + l[2] + l[3];
+    }
+
+    template <typename T>
+    void accumulateRow(const T* r0, const T* r1, const T* r2, int x0, int x1, FocusSums& s)
+    {
+        const __m128i ones = _mm_set1_epi16(1);
+        int x = x0;
+        while (x + 8 <= x1) {
+            __m128i lap = _mm_setzero_si128(), lap2 = lap, ten = lap, bren = lap;
+            for (int step = 0; step < flushSteps<T>() && x + 8 <= x1; ++step, x += 8) {
+                const __m128i a0 = load8(r0 + x - 1), b0 = load8(r0 + x), c0 = load8(r0 + x + 1);
+                const __m128i a1 = load8(r1 + x - 1), b1 = load8(r1 + x), c1 = load8(r1 + x + 1);
+                const __m128i a2 = load8(r2 + x - 1), b2 = load8(r2 + x), c2 = load8(r2 + x + 1);
+                const __m128i l = _mm_sub_epi16(_mm_add_epi16(_mm_add_epi16(b0, b2), _mm_add_epi16(a1, c1)),
+                                                _mm_slli_epi16(b1, 2));
+                const __m128i dx = _mm_sub_epi16(c1, a1);
+                const __m128i gx = _mm_add_epi16(_mm_add_epi16(_mm_sub_epi16(c0, a0), _mm_sub_epi16(c2, a2)),
+                                                 _mm_slli_epi16(dx, 1));
+                const __m128i gy = _mm_add_epi16(_mm_add_epi16(_mm_sub_epi16(a2, a0), _mm_sub_epi16(c2, c0)),
+                                                 _mm_slli_epi16(_mm_sub_epi16(b2, b0), 1));
+                lap = _mm_add_epi32(lap, _mm_madd_epi16(l, ones));
+                lap2 = _mm_add_epi32(lap2, _mm_madd_epi16(l, l));
+                ten = _mm_add_epi32(ten, _mm_add_epi32(_mm_madd_epi16(gx, gx), _mm_madd_epi16(gy, gy)));
+                bren = _mm_add_epi32(bren, _mm_madd_epi16(dx, dx));
+            }
+            s.lap += laneSum(lap);
+            s.lap2 += laneSum(lap2);
+            s.ten += laneSum(ten);
+            s.bren += laneSum(bren);
+        }
+        s.count += x - x0;
+        accumulateScalar(r0, r1, r2, x, x1, s);
+    }
+#elif defined(DUALCAM_FOCUS_NEON)
+    inline int16x8_t load8(const uint8_t* p)
+    {
+        return vreinterpretq_s16_u16(vmovl_u8(vld1_u8(p)));
+    }
+    inline int16x8_t load8(const uint16_t* p)
+    {
+        return vreinterpretq_s16_u16(vshrq_n_u16(vld1q_u16(p), kShift16));
+    }
+
+    inline int32x4_t squares(int32x4_t acc, int16x8_t v)
+    {
+        return vmlal_s16(vmlal_s16(acc, vget_low_s16(v), vget_low_s16(v)), vget_high_s16(v), vget_high_s16(v));
+    }
+
+    inline int64_t laneSum(int32x4_t v)
+    {
+        int32_t l[4];
+        vst1q_s32(l, v);
+        return static_cast<int64_t>(l[0]) + l[1] + l[2] + l[3];
+    }
+
+    template <typename T>
+    void accumulateRow(const T* r0, const T* r1, const T* r2, int x0, int x1, FocusSums& s)
+    {
+        int x = x0;
+        while (x + 8 <= x1) {
+            int32x4_t lap = vdupq_n_s32(0), lap2 = lap, ten = lap, bren = lap;
+            for (int step = 0; step < flushSteps<T>() && x + 8 <= x1; ++step, x += 8) {
+                const int16x8_t a0 = load8(r0 + x - 1), b0 = load8(r0 + x), c0 = load8(r0 + x + 1);
+                const int16x8_t a1 = load8(r1 + x - 1), b1 = load8(r1 + x), c1 = load8(r1 + x + 1);
+                const int16x8_t a2 = load8(r2 + x - 1), b2 = load8(r2 + x), c2 = load8(r2 + x + 1);
+                const int16x8_t l = vsubq_s16(vaddq_s16(vaddq_s16(b0, b2), vaddq_s16(a1, c1)), vshlq_n_s16(b1, 2));
+                const int16x8_t dx = vsubq_s16(c1, a1);
+                const int16x8_t gx = vaddq_s16(vaddq_s16(vsubq_s16(c0, a0), vsubq_s16(c2, a2)), vshlq_n_s16(dx, 1));
+                const int16x8_t gy = vaddq_s16(vaddq_s16(vsubq_s16(a2, a0), vsubq_s16(c2, c0)),
+                                               vshlq_n_s16(vsubq_s16(b2, b0), 1));
+                lap = vpadalq_s16(lap, l);
+                lap2 = squares(lap2, l);
+                ten = squares(squares(ten, gx), gy);
+                bren = squares(bren, dx);
+            }
+            s.lap += laneSum(lap);
+            s.lap2 += laneSum(lap2);
+            s.ten += laneSum(ten);
+            s.bren += laneSum(bren);
+        }
+        s.count += x - x0;
+        accumulateScalar(r0, r1, r2, x, x1, s);
+    }
+#else
+    template <typename T>
+    void accumulateRow(const T* r0, const T* r1, const T* r2, int x0, int x1, FocusSums& s)
+    {
+        accumulateScalar(r0, r1, r2, x0, x1, s);
+    }
+#endif
+
+    double laplacianVariance(const FocusSums& s)
+    {
+        if (s.count == 0) return 0.0;
+        const double mean = static_cast<double>(s.lap) / s.count;
+        return std::max(0.0, static_cast<double>(s.lap2) / s.count - mean * mean);
+    }
+
+    template void accumulateScalar<uint8_t>(const uint8_t*, const uint8_t*, const uint8_t*, int, int, FocusSums&);
+    template void accumulateScalar<uint16_t>(const uint16_t*, const uint16_t*, const uint16_t*, int, int, FocusSums&);
+    template void accumulateRow<uint8_t>(const uint8_t*, const uint8_t*, const uint8_t*, int, int, FocusSums&);
+    template void accumulateRow<uint16_t>(const uint16_t*, const uint16_t*, const uint16_t*, int, int, FocusSums&);
+}
+
+FocusMetrics measureFocus(const cv::Mat& frame, const cv::Size& grid)
+{
+    using namespace focus_detail;
+    FocusMetrics out;
+    if (frame.empty()) return out;
+    cv::Mat gray;
+    if (frame.channels() == 3) cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+    else gray = frame;
+    if ((gray.depth() != CV_8U && gray.depth() != CV_16U) || gray.rows < 3 || gray.cols < 3) return out;
+
+    /* Without a map the whole interior is one tile. */
+    const int gw = std::max(1, grid.width);
+    const int gh = std::max(1, grid.height);
+    const int innerRows = gray.rows - 2;
+    std::vector<int> edges(gw + 1);
+    for (int i = 0; i <= gw; ++i) edges[i] = 1 + (gray.cols - 2) * i / gw;
+
+    /* Rows run on the calling thread: measureFocus is called from every
+       camera's stage worker at once, where a cv::parallel_for_ would only
+       wait for the others. */
+    std::vector<FocusSums> tiles(static_cast<size_t>(gw) * gh);
+    const bool eight = gray.depth() == CV_8U;
+    for (int y = 1; y < gray.rows - 1; ++y) {
+        FocusSums* row = &tiles[static_cast<size_t>(std::min(gh - 1, (y - 1) * gh / innerRows)) * gw];
+        for (int tx = 0; tx < gw; ++tx) {
+            if (eight)
+                accumulateRow(gray.ptr<uint8_t>(y - 1), gray.ptr<uint8_t>(y), gray.ptr<uint8_t>(y + 1),
+                              edges[tx], edges[tx + 1], row[tx]);
+            else
+                accumulateRow(gray.ptr<uint16_t>(y - 1), gray.ptr<uint16_t>(y), gray.ptr<uint16_t>(y + 1),
+                              edges[tx], edges[tx + 1], row[tx]);
+        }
+    }
+
+    /* One 10-bit step is 2^kShift16 16-bit counts, one 8-bit step kStep16. */
+    const double k = eight ? 1.0 : (1 << kShift16) / kStep16;
+    const double k2 = k * k;
+    FocusSums total;
+    for (const FocusSums& t : tiles) total += t;
+    out.laplacian = laplacianVariance(total) * k2;
+    if (total.count > 0) {
+        out.tenengrad = static_cast<double>(total.ten) / total.count * k2;
+        out.brenner = static_cast<double>(total.bren) / total.count * k2;
+    }
+    if (grid.area() > 0) {
+        out.map.create(gh, gw, CV_64F);
+        for (int ty = 0; ty < gh; ++ty)
+            for (int tx = 0; tx < gw; ++tx)
+                out.map.at<double>(ty, tx) = laplacianVariance(tiles[static_cast<size_t>(ty) * gw + tx]) * k2;
+    }
+    return out;
+}
@@ -0,0 +1,30 @@
+#ifndef FOCUS_METRICS_H
+#define FOCUS_METRICS_H
+
+#include <opencv2/core.hpp>
+
+/* Sharpness of one frame, all in 8-bit units whatever the frame depth. */
+struct FocusMetrics {
+    /* Variance of the 4-neighbour Laplacian; the score shown in the focus
+       chart. */
+    double laplacian = 0.0;
+    /* Mean Sobel gradient energy gx^2 + gy^2. */
+    double tenengrad = 0.0;
+    /* Mean squared difference of pixels two apart horizontally. */
+    double brenner = 0.0;
+    /* Laplacian variance per tile, grid.height x grid.width CV_64F; empty
+       unless a grid was asked for. */
+    cv::Mat map;
+};
+
+/* All three metrics and the optional tile map in one pass over the frame:
+   every output pixel needs only its 3x3 neighbourhood, so the Laplacian,
+   the Sobel pair and the Brenner difference share their loads and go
+   straight into 16-bit products summed in 32-bit lanes (SSE2 or NEON),
+   with no full-frame temporaries. 16-bit frames are measured at 10 bits.
+   The one-pixel border is skipped. Colour frames are converted to gray
+   first. Runs on the calling thread. The SIMD rows match the scalar loop
+   exactly (test_focus_metrics.cpp). */
+FocusMetrics measureFocus(const cv::Mat& frame, const cv::Size& grid = cv::Size());
+
+#endif // FOCUS_METRICS_H
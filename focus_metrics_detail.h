@@ -0,0 +1,43 @@
+#ifndef FOCUS_METRICS_DETAIL_H
+#define FOCUS_METRICS_DETAIL_H
+
+#include <cstdint>
+
+/* Building blocks of measureFocus(), exposed for test_focus_metrics.cpp. */
+namespace focus_detail {
+    /* 16-bit frames are reduced to 10 bits so that every term, up to
+       4 * 1023 for the Sobel pair, fits in an int16 lane. */
+    constexpr int kShift16 = 6;
+
+    struct FocusSums {
+        int64_t lap = 0;
+        int64_t lap2 = 0;
+        int64_t ten = 0;
+        int64_t bren = 0;
+        int64_t count = 0;
+
+        FocusSums& operator+=(const FocusSums& o)
+        {
+            lap += o.lap;
+            lap2 += o.lap2;
+            ten += o.ten;
+            bren += o.bren;
+            count += o.count;
+            return *this;
+        }
+    };
+
+    /* Interior pixels x0..x1-1 of row r1, with r0 above and r2 below. The
+       Brenner difference is taken centred on x, the same pair the Sobel
+       gx weights twice. T is uint8_t or uint16_t. */
+    template <typename T>
+    void accumulateScalar(const T* r0, const T* r1, const T* r2, int x0, int x1, FocusSums& s);
+    /* The same sums, SSE2 or NEON where available; bit-exact with the
+       scalar loop. */
+    template <typename T>
+    void accumulateRow(const T* r0, const T* r1, const T* r2, int x0, int x1, FocusSums& s);
+
+    double laplacianVariance(const FocusSums& s);
+}
+
+#endif // FOCUS_METRICS_DETAIL_H
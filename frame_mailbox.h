@@ -0,0 +1,53 @@
+#ifndef FRAME_MAILBOX_H
+#define FRAME_MAILBOX_H
+
+#include <atomic>
+#include <cstdint>
+
+/* Single-producer / single-consumer "latest value" triple buffer.
+   The producer fills writeSlot() and publish()es it; the consumer fetch()es
+   and reads readSlot(). Neither side ever blocks, and the consumer always
+   gets the newest published slot — intermediate ones are overwritten. */
+template <typename T>
+class FrameMailbox {
+public:
+    FrameMailbox() { static_assert(std::atomic<uint8_t>::is_always_lock_free, "mailbox needs a lock-free byte"); }
+
+    T& writeSlot() { return m_slots[m_back]; }
+
+    void publish()
+    {
+        const uint8_t prev = m_middle.exchange(static_cast<uint8_t>(m_back | kFresh), std::memory_order_acq_rel);
+        m_back = prev & kIndexMask;
+    }
+
+    bool fetch()
+    {
+        if (!(m_middle.load(std::memory_order_acquire) & kFresh)) return false;
+        const uint8_t prev = m_middle.exchange(m_front, std::memory_order_acq_rel);
+        m_front = prev & kIndexMask;
+        return true;
+    }
+
+    T& readSlot() { return m_slots[m_front]; }
+    const T& readSlot() const { return m_slots[m_front]; }
+
+    /* Only valid while neither side is running. */
+    void reset()
+    {
+        m_back = 0;
+        m_middle.store(1, std::memory_order_release);
+        m_front = 2;
+    }
+
+private:
+    static constexpr uint8_t kIndexMask = 0x3;
+    static constexpr uint8_t kFresh = 0x4;
+
+    T m_slots[3];
+    uint8_t m_back = 0;
+    std::atomic<uint8_t> m_middle{1};
+    uint8_t m_front = 2;
+};
+
+#endif // FRAME_MAILBOX_H
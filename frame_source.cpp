@@ -0,0 +1,484 @@
+#include "frame_source.h"
+#include "gst_capture.h"
+#include "v4l2_capture.h"
+#include "pixel_depth.h"
+
+#include <opencv2/imgproc.hpp>
+#include <opencv2/videoio.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+constexpr double kNominalOfflineFps = 30.0;
+
+class FramePacer {
+public:
+    explicit FramePacer(double fps)
+        : m_periodNs(fps > 0.0 ? static_cast<int64_t>(1e9 / fps) : 0) {}
+
+    void wait()
+    {
+        if (m_periodNs <= 0) return;
+        const int64_t now = monotonicNowNs();
+        if (m_next == 0 || now - m_next > 4 * m_periodNs) {
+            m_next = now;
+        } else if (m_next > now) {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(m_next - now));
+        }
+        m_next += m_periodNs;
+    }
+
+private:
+    int64_t m_periodNs;
+    int64_t m_next = 0;
+};
+
+/* Tags frames with the exposure generation they were captured under. A
+   change requested after frame N was delivered takes effect from frame
+   N + 1 + latency: the frames already queued in the driver/ISP and the
+   sensor's own control delay still carry the old settings. */
+class ExposureTracker {
+public:
+    explicit ExposureTracker(int latencyFrames) : m_latency(latencyFrames) {}
+
+    void requested(uint32_t generation)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pendingGen = generation;
+        m_effectiveSeq = m_lastSeq + 1 + m_latency;
+        m_pending = true;
+    }
+
+    uint32_t tag(int64_t seq)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_lastSeq = seq;
+        if (m_pending && seq >= m_effectiveSeq) {
+            m_gen = m_pendingGen;
+            m_pending = false;
+        }
+        return m_gen;
+    }
+
+private:
+    std::mutex m_mutex;
+    int m_latency;
+    int64_t m_lastSeq = -1;
+    int64_t m_effectiveSeq = 0;
+    uint32_t m_gen = 0;
+    uint32_t m_pendingGen = 0;
+    bool m_pending = false;
+};
+
+/* libcamerasrc keeps a few requests in flight ahead of appsink; a V4L2
+   sensor typically latches new exposure two frames after the write. */
+constexpr int kLibcameraControlLatency = 4;
+constexpr int kV4L2ControlLatency = 2;
+
+int64_t offlinePeriodNs(double rateFps)
+{
+    return static_cast<int64_t>(1e9 / (rateFps > 0.0 ? rateFps : kNominalOfflineFps));
+}
+
+class VideoCaptureSource : public FrameSource {
+public:
+    using Opener = std::function<bool(cv::VideoCapture&)>;
+
+    VideoCaptureSource(std::string desc, Opener opener)
+        : m_desc(std::move(desc)), m_opener(std::move(opener)) {}
+
+    bool open() { return m_opener(m_cap) && m_cap.isOpened(); }
+    bool isOpened() const override { return m_cap.isOpened(); }
+    void close() override { if (m_cap.isOpened()) m_cap.release(); }
+    std::string describe() const override { return m_desc; }
+
+    bool reopen() override
+    {
+        close();
+        return open();
+    }
+
+    bool read(TimedFrame& out, bool) override
+    {
+        if (!m_cap.grab()) return false;
+        /* Stamp on grab completion, before the (possibly slow) retrieve, so
+           the pairing stage sees when the buffer actually arrived. */
+        out.timestampNs = monotonicNowNs();
+        if (!m_cap.retrieve(out.image) || out.image.empty()) return false;
+        out.seq = m_seq++;
+        return true;
+    }
+
+private:
+    cv::VideoCapture m_cap;
+    std::string m_desc;
+    Opener m_opener;
+    int64_t m_seq = 0;
+};
+
+/* Remembers the last exposure pushed to a live source so a reopened stream
+   comes back with it rather than with the settings it was built with. The
+   mutex also keeps setExposure (GUI thread) off a stream being reopened
+   (capture thread). */
+class ExposureMemory {
+public:
+    template <typename Apply>
+    bool set(const ExposureSettings& e, Apply apply)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!apply(e)) return false;
+        m_last = e;
+        m_valid = true;
+        return true;
+    }
+
+    template <typename Reopen, typename Apply>
+    bool reopen(Reopen doReopen, Apply apply)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!doReopen()) return false;
+        if (m_valid) apply(m_last);
+        return true;
+    }
+
+private:
+    std::mutex m_mutex;
+    ExposureSettings m_last;
+    bool m_valid = false;
+};
+
+class AppSinkSource : public FrameSource {
+public:
+    explicit AppSinkSource(std::string pipeline) : m_pipeline(std::move(pipeline)) {}
+
+    bool open() { return m_cap.open(m_pipeline); }
+    bool isOpened() const override { return m_cap.isOpened(); }
+    void close() override { m_cap.release(); }
+    std::string describe() const override { return "gstreamer appsink"; }
+
+    bool read(TimedFrame& out, bool color) override
+    {
+        if (!m_cap.read(out.image, out.owner, out.timestampNs, color)) return false;
+        out.seq = m_seq++;
+        out.exposureGen = m_exposure.tag(out.seq);
+        return true;
+    }
+
+    bool setExposure(const ExposureSettings& e, uint32_t generation) override
+    {
+        if (!m_applied.set(e, [this](const ExposureSettings& s) { return apply(s); })) return false;
+        m_exposure.requested(generation);
+        return true;
+    }
+
+    bool reopen() override
+    {
+        return m_applied.reopen([this]() { m_cap.release(); return open(); },
+                                [this](const ExposureSettings& s) { return apply(s); });
+    }
+
+private:
+    bool apply(const ExposureSettings& e) { return m_cap.setExposure(e.manual, e.gain, e.shutterUs); }
+
+    GstAppSinkCapture m_cap;
+    std::string m_pipeline;
+    int64_t m_seq = 0;
+    ExposureTracker m_exposure{kLibcameraControlLatency};
+    ExposureMemory m_applied;
+};
+
+class V4L2Source : public FrameSource {
+public:
+    V4L2Source(std::string device, int w, int h, int fps, bool highBitDepth)
+        : m_device(std::move(device)), m_w(w), m_h(h), m_fps(fps), m_highBitDepth(highBitDepth) {}
+
+    bool open() { return m_cap.open(m_device, m_w, m_h, m_fps, m_highBitDepth); }
+    bool isOpened() const override { return m_cap.isOpened(); }
+    void close() override { m_cap.close(); }
+    int64_t droppedFrames() const override { return m_droppedBefore + m_cap.droppedFrames(); }
+    std::string describe() const override { return "v4l2 " + m_device; }
+
+    bool read(TimedFrame& out, bool color) override
+    {
+        if (!m_cap.read(out, color)) return false;
+        /* The kernel sequence restarts at 0 on every STREAMON. */
+        out.seq += m_seqBase;
+        m_lastSeq = out.seq;
+        out.exposureGen = m_exposure.tag(out.seq);
+        return true;
+    }
+
+    bool setExposure(const ExposureSettings& e, uint32_t generation) override
+    {
+        if (!m_applied.set(e, [this](const ExposureSettings& s) { return apply(s); })) return false;
+        m_exposure.requested(generation);
+        return true;
+    }
+
+    bool reopen() override
+    {
+        return m_applied.reopen([this]() {
+            if (m_cap.isOpened()) m_droppedBefore += m_cap.droppedFrames();
+            m_seqBase = m_lastSeq + 1;
+            m_cap.close();
+            return open();
+        }, [this](const ExposureSettings& s) { return apply(s); });
+    }
+
+private:
+    bool apply(const ExposureSettings& e) { return m_cap.setExposure(e.manual, e.gain, e.shutterUs); }
+
+    V4L2Capture m_cap;
+    std::string m_device;
+    int m_w, m_h, m_fps;
+    bool m_highBitDepth;
+    int64_t m_seqBase = 0;
+    int64_t m_lastSeq = -1;
+    std::atomic<int64_t> m_droppedBefore{0};
+    ExposureTracker m_exposure{kV4L2ControlLatency};
+    ExposureMemory m_applied;
+};
+
+class FileSource : public FrameSource {
+public:
+    FileSource(const std::string& path, double rateFps, bool loop)
+        : m_path(path), m_pacer(rateFps), m_periodNs(offlinePeriodNs(rateFps)), m_loop(loop)
+    {
+        m_cap.open(path);
+    }
+
+    bool isOpened() const override { return m_cap.isOpened(); }
+    void close() override { if (m_cap.isOpened()) m_cap.release(); }
+    bool isLive() const override { return false; }
+    bool finished() const override { return m_finished; }
+    std::string describe() const override { return "file " + m_path; }
+
+    bool read(TimedFrame& out, bool) override
+    {
+        if (m_finished) return false;
+        m_pacer.wait();
+        if (!m_cap.read(out.image) || out.image.empty()) {
+            if (!m_loop || m_index == 0) {
+                m_finished = true;
+                return false;
+            }
+            m_cap.set(cv::CAP_PROP_POS_FRAMES, 0);
+            if (!m_cap.read(out.image) || out.image.empty()) {
+                m_finished = true;
+                return false;
+            }
+        }
+        out.timestampNs = m_index * m_periodNs;
+        out.seq = m_index++;
+        return true;
+    }
+
+private:
+    cv::VideoCapture m_cap;
+    std::string m_path;
+    FramePacer m_pacer;
+    int64_t m_periodNs;
+    int64_t m_index = 0;
+    bool m_loop;
+    bool m_finished = false;
+};
+
+/* Deterministic scene generator: every camera crops the same textured
+   plane; camera k (0-based) is displaced by k * (offsetX, offsetY) and every
+   camera but the first is blurred, the crop window
+   oscillates at up to motionPx pixels per frame, and each frame gets
+   Gaussian noise seeded by (seed, cam, frame index). */
+class SyntheticSource : public FrameSource {
+public:
+    SyntheticSource(int cam, const SyntheticParams& p, double rateFps)
+        : m_cam(cam), m_p(p), m_pacer(rateFps), m_periodNs(offlinePeriodNs(rateFps))
+    {
+        m_p.width  = std::max(16, m_p.width);
+        m_p.height = std::max(16, m_p.height);
+        m_amplitude = (m_p.motionPx > 0.0) ? std::min(48.0, m_p.width / 8.0) : 0.0;
+        /* Sized for cam 2 so two-camera runs stay bit-identical; further
+           cameras may reach past the margin, where getRectSubPix replicates
+           the border. */
+        const int margin = 8 + static_cast<int>(std::ceil(m_amplitude
+            + std::max(std::abs(m_p.offsetX), std::abs(m_p.offsetY))));
+
+        const cv::Size texSz(m_p.width + 2 * margin, m_p.height + 2 * margin);
+        cv::RNG rng(m_p.seed);
+        cv::Mat coarse(texSz.height / 16 + 1, texSz.width / 16 + 1, CV_8UC3);
+        rng.fill(coarse, cv::RNG::UNIFORM, 40, 200);
+        cv::resize(coarse, m_texture, texSz, 0, 0, cv::INTER_CUBIC);
+
+        for (int x = 0; x < texSz.width; x += 64) {
+            cv::line(m_texture, cv::Point(x, 0), cv::Point(x, texSz.height - 1), cv::Scalar(235, 235, 235), 1);
+        }
+        for (int y = 0; y < texSz.height; y += 64) {
+            cv::line(m_texture, cv::Point(0, y), cv::Point(texSz.width - 1, y), cv::Scalar(235, 235, 235), 1);
+        }
+        for (int i = 0; i < 80; ++i) {
+            const cv::Point c(rng.uniform(0, texSz.width), rng.uniform(0, texSz.height));
+            const cv::Scalar color(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256));
+            if (i % 2 == 0) {
+                cv::circle(m_texture, c, rng.uniform(4, 40), color, rng.uniform(-1, 4));
+            } else {
+                const cv::Point d(rng.uniform(-60, 60), rng.uniform(-60, 60));
+                cv::rectangle(m_texture, c, c + d, color, rng.uniform(-1, 4));
+            }
+        }
+        cv::cvtColor(m_texture, m_textureGray, cv::COLOR_BGR2GRAY);
+    }
+
+    bool isOpened() const override { return !m_texture.empty(); }
+    void close() override {}
+    bool isLive() const override { return false; }
+    std::string describe() const override { return "synthetic cam " + std::to_string(m_cam + 1); }
+
+    bool read(TimedFrame& out, bool color) override
+    {
+        m_pacer.wait();
+        const int64_t n = m_index++;
+
+        const double phase = (m_amplitude > 0.0) ? n * m_p.motionPx / m_amplitude : 0.0;
+        cv::Point2f center(
+            static_cast<float>(m_texture.cols / 2.0 + m_amplitude * std::sin(phase)),
+            static_cast<float>(m_texture.rows / 2.0 + 0.5 * m_amplitude * std::sin(0.7 * phase)));
+        center.x += static_cast<float>(m_cam * m_p.offsetX);
+        center.y += static_cast<float>(m_cam * m_p.offsetY);
+        const cv::Mat& tex = color ? m_texture : m_textureGray;
+        if (m_p.bitDepth == 16) {
+            /* Sub-pixel interpolation in float keeps the fractional part, so
+               the 16-bit stream carries genuinely finer levels than 8-bit. */
+            cv::Mat patch;
+            cv::getRectSubPix(tex, cv::Size(m_p.width, m_p.height), center, patch, CV_32F);
+            patch.convertTo(out.image, CV_16U, kStep16);
+        } else {
+            cv::getRectSubPix(tex, cv::Size(m_p.width, m_p.height), center, out.image);
+        }
+
+        if (m_cam > 0 && m_p.blurSigma2 > 0.0) {
+            cv::GaussianBlur(out.image, out.image, cv::Size(), m_p.blurSigma2);
+        }
+        if (m_p.noiseSigma > 0.0) {
+            cv::RNG rng(m_p.seed * 0x9E3779B97F4A7C15ULL
+                        ^ (static_cast<uint64_t>(n) << 1) ^ static_cast<uint64_t>(m_cam + 1));
+            cv::Mat noise(out.image.size(), CV_32SC(out.image.channels()));
+            rng.fill(noise, cv::RNG::NORMAL, 0.0, m_p.noiseSigma * pixelScale(out.image.depth()));
+            cv::add(out.image, noise, out.image, cv::noArray(), out.image.depth());
+        }
+
+        out.timestampNs = n * m_periodNs;
+        out.seq = n;
+        return true;
+    }
+
+private:
+    int m_cam;
+    SyntheticParams m_p;
+    FramePacer m_pacer;
+    int64_t m_periodNs;
+    int64_t m_index = 0;
+    double m_amplitude = 0.0;
+    cv::Mat m_texture;
+    cv::Mat m_textureGray;
+};
+
+}
+
+std::unique_ptr<FrameSource> makeGStreamerSource(const std::string& pipeline)
+{
+    auto src = std::make_unique<VideoCaptureSource>("gstreamer", [pipeline](cv::VideoCapture& cap) {
+        return cap.open(pipeline, cv::CAP_GSTREAMER);
+    });
+    if (!src->open()) return nullptr;
+    return src;
+}
+
+std::unique_ptr<FrameSource> makeAppSinkSource(const std::string& pipeline)
+{
+    if (!GstAppSinkCapture::available()) return nullptr;
+    auto src = std::make_unique<AppSinkSource>(pipeline);
+    if (!src->open()) return nullptr;
+    return src;
+}
+
+std::unique_ptr<FrameSource> makeV4L2Source(const std::string& device, int w, int h, int fps, bool highBitDepth)
+{
+    if (!V4L2Capture::available()) return nullptr;
+    auto src = std::make_unique<V4L2Source>(device, w, h, fps, highBitDepth);
+    if (!src->open()) return nullptr;
+    return src;
+}
+
+std::unique_ptr<FrameSource> makeDeviceSource(int index, int w, int h, int fps, bool highBitDepth)
+{
+    if (auto native = makeV4L2Source("/dev/video" + std::to_string(index), w, h, fps, highBitDepth)) {
+        return native;
+    }
+
+    auto src = std::make_unique<VideoCaptureSource>("device " + std::to_string(index),
+        [index, w, h, fps](cv::VideoCapture& cap) {
+#ifdef __linux__
+            cap.open(index, cv::CAP_V4L2);
+#else
+            cap.open(index, cv::CAP_DSHOW);
+#endif
+            if (!cap.isOpened()) return false;
+            cap.set(cv::CAP_PROP_FRAME_WIDTH, w);
+            cap.set(cv::CAP_PROP_FRAME_HEIGHT, h);
+            cap.set(cv::CAP_PROP_FPS, fps);
+            return true;
+        });
+    if (!src->open()) return nullptr;
+    return src;
+}
+
+std::unique_ptr<FrameSource> makeFileSource(const std::string& path, double rateFps, bool loop)
+{
+    auto src = std::make_unique<FileSource>(path, rateFps, loop);
+    if (!src->isOpened()) return nullptr;
+    return src;
+}
+
+std::unique_ptr<FrameSource> makeSyntheticSource(int cam, const SyntheticParams& params, double rateFps)
+{
+    return std::make_unique<SyntheticSource>(cam, params, rateFps);
+}
+
+bool parseSyntheticParams(const std::string& text, SyntheticParams& out)
+{
+    SyntheticParams p = out;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) continue;
+        const size_t eq = item.find('=');
+        if (eq == std::string::npos) return false;
+        const std::string key = item.substr(0, eq);
+        const std::string val = item.substr(eq + 1);
+        try {
+            if      (key == "noise")  p.noiseSigma = std::stod(val);
+            else if (key == "motion") p.motionPx   = std::stod(val);
+            else if (key == "dx")     p.offsetX    = std::stod(val);
+            else if (key == "dy")     p.offsetY    = std::stod(val);
+            else if (key == "blur")   p.blurSigma2 = std::stod(val);
+            else if (key == "seed")   p.seed       = std::stoull(val);
+            else if (key == "depth") {
+                p.bitDepth = std::stoi(val);
+                if (p.bitDepth != 8 && p.bitDepth != 16) return false;
+            }
+            else return false;
+        }
+        catch (const std::exception&) {
+            return false;
+        }
+    }
+    out = p;
+    return true;
+}
@@ -0,0 +1,75 @@
+#ifndef FRAME_SOURCE_H
+#define FRAME_SOURCE_H
+
+#include "frame_sync.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct ExposureSettings {
+    bool manual = false;
+    double gain = 1.0;
+    int shutterUs = 10000;
+};
+
+/* One camera stream. read() blocks until the next frame (or a backend
+   timeout) and fills image, timestampNs and seq. Live backends stamp with
+   the capture clock; offline backends stamp with frameIndex * period so that
+   frame N of both streams always pairs exactly. */
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+
+    virtual bool isOpened() const = 0;
+    virtual void close() = 0;
+    virtual bool read(TimedFrame& out, bool color) = 0;
+    virtual bool isLive() const { return true; }
+    virtual bool finished() const { return false; }
+    virtual int64_t droppedFrames() const { return 0; }
+    /* Applies exposure to the running stream. Frames captured under it carry
+       TimedFrame::exposureGen == generation; false means the backend needs a
+       restart to change exposure. */
+    virtual bool setExposure(const ExposureSettings&, uint32_t) { return false; }
+    /* Tears the stream down and opens it again with the original settings
+       and the last applied exposure, after a disconnect or stall. seq keeps
+       counting up across the reopen. Offline sources cannot reopen. */
+    virtual bool reopen() { return false; }
+    virtual std::string describe() const = 0;
+};
+
+enum class SourceKind { Live, Files, Synthetic };
+
+struct SyntheticParams {
+    int width = 640;
+    int height = 480;
+    double noiseSigma = 4.0;
+    double motionPx = 1.5;
+    double offsetX = 6.0;
+    double offsetY = -3.0;
+    double blurSigma2 = 1.0;
+    uint64_t seed = 1;
+    int bitDepth = 8;
+};
+
+struct SourceSpec {
+    SourceKind kind = SourceKind::Live;
+    int cameras = 2;
+    std::vector<std::string> paths;
+    double rateFps = 0.0;
+    bool loop = true;
+    SyntheticParams synth;
+};
+
+std::unique_ptr<FrameSource> makeGStreamerSource(const std::string& pipeline);
+std::unique_ptr<FrameSource> makeAppSinkSource(const std::string& pipeline);
+std::unique_ptr<FrameSource> makeV4L2Source(const std::string& device, int w, int h, int fps,
+                                            bool highBitDepth = false);
+std::unique_ptr<FrameSource> makeDeviceSource(int index, int w, int h, int fps, bool highBitDepth = false);
+std::unique_ptr<FrameSource> makeFileSource(const std::string& path, double rateFps, bool loop);
+std::unique_ptr<FrameSource> makeSyntheticSource(int cam, const SyntheticParams& params, double rateFps);
+
+bool parseSyntheticParams(const std::string& text, SyntheticParams& out);
+
+#endif // FRAME_SOURCE_H
@@ -0,0 +1,202 @@
+#include "frame_sync.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+
+int64_t monotonicNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+FrameSync::FrameSync(size_t depth)
+    : m_queues(2), m_depth(depth < 1 ? 1 : depth)
+{
+}
+
+void FrameSync::setCameraCount(int count)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queues.assign(static_cast<size_t>(count < 1 ? 1 : count), {});
+}
+
+int FrameSync::cameraCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<int>(m_queues.size());
+}
+
+void FrameSync::push(int cam, TimedFrame frame)
+{
+    /* Only this camera's capture thread adds to its queue, so the count can
+       only drop before the frame goes in; the copy is made outside the
+       lock. */
+    if (frame.owner) {
+        size_t pinned = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (cam >= 0 && cam < static_cast<int>(m_queues.size())) {
+                const auto& q = m_queues[cam];
+                pinned = static_cast<size_t>(std::count_if(q.begin(), q.end(),
+                    [](const TimedFrame& f) { return static_cast<bool>(f.owner); }));
+            }
+        }
+        if (pinned >= kMaxPinnedQueued) {
+            frame.image = frame.image.clone();
+            frame.owner.reset();
+        }
+    }
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (cam < 0 || cam >= static_cast<int>(m_queues.size())) return;
+        auto& q = m_queues[cam];
+        if (m_lossless) {
+            m_cv.wait(lock, [&]() { return q.size() < m_depth || m_woken; });
+            if (m_woken) return;
+        }
+        q.push_back(std::move(frame));
+        while (q.size() > m_depth) {
+            q.pop_front();
+            ++m_dropped;
+        }
+    }
+    m_cv.notify_all();
+}
+
+void FrameSync::setPolicy(PairingPolicy policy, int64_t maxSkewNs)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_policy = policy;
+    m_maxSkewNs = maxSkewNs > 0 ? maxSkewNs : 0;
+}
+
+void FrameSync::setLossless(bool lossless)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_lossless = lossless;
+    }
+    m_cv.notify_all();
+}
+
+void FrameSync::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& q : m_queues) q.clear();
+    m_dropped = 0;
+    m_woken = false;
+}
+
+void FrameSync::wake()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_woken = true;
+    }
+    m_cv.notify_all();
+}
+
+int64_t FrameSync::droppedFrames() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_dropped;
+}
+
+double FrameSync::fill() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_queues.empty() || m_depth == 0) return 0.0;
+    size_t queued = 0;
+    for (const auto& q : m_queues) queued += q.size();
+    return static_cast<double>(queued) / static_cast<double>(m_queues.size() * m_depth);
+}
+
+bool FrameSync::waitSet(std::vector<TimedFrame>& out, int64_t& skewNs, int timeoutMs)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!m_woken) {
+        if (trySetLocked(out, skewNs)) {
+            if (m_lossless) m_cv.notify_all();
+            return true;
+        }
+        if (m_cv.wait_until(lock, deadline) == std::cv_status::timeout) {
+            const bool ok = trySetLocked(out, skewNs);
+            if (ok && m_lossless) m_cv.notify_all();
+            return ok;
+        }
+    }
+    return false;
+}
+
+bool FrameSync::trySetLocked(std::vector<TimedFrame>& out, int64_t& skewNs)
+{
+    const size_t n = m_queues.size();
+    for (const auto& q : m_queues) {
+        if (q.empty()) return false;
+    }
+    out.resize(n);
+
+    if (m_policy == PairingPolicy::LatestOfEach) {
+        int64_t tMin = INT64_MAX, tMax = INT64_MIN;
+        for (size_t c = 0; c < n; ++c) {
+            auto& q = m_queues[c];
+            m_dropped += static_cast<int64_t>(q.size() - 1);
+            out[c] = std::move(q.back());
+            q.clear();
+            tMin = std::min(tMin, out[c].timestampNs);
+            tMax = std::max(tMax, out[c].timestampNs);
+        }
+        skewNs = tMax - tMin;
+        return true;
+    }
+
+    /* The camera whose newest frame is oldest is the anchor: every frame the
+       other cameras could still deliver is later than its newest frame, so
+       their nearest partners for it are already queued. */
+    size_t anchor = 0;
+    for (size_t c = 1; c < n; ++c) {
+        if (m_queues[c].back().timestampNs < m_queues[anchor].back().timestampNs) anchor = c;
+    }
+    const int64_t tAnchor = m_queues[anchor].back().timestampNs;
+
+    std::vector<size_t> best(n, 0);
+    int64_t tMin = tAnchor, tMax = tAnchor;
+    for (size_t c = 0; c < n; ++c) {
+        auto& q = m_queues[c];
+        if (c == anchor) {
+            best[c] = q.size() - 1;
+            continue;
+        }
+        int64_t bestSkew = std::llabs(q[0].timestampNs - tAnchor);
+        for (size_t i = 1; i < q.size(); ++i) {
+            const int64_t s = std::llabs(q[i].timestampNs - tAnchor);
+            if (s < bestSkew) { bestSkew = s; best[c] = i; }
+        }
+        tMin = std::min(tMin, q[best[c]].timestampNs);
+        tMax = std::max(tMax, q[best[c]].timestampNs);
+    }
+
+    for (size_t c = 0; c < n; ++c) {
+        auto& q = m_queues[c];
+        m_dropped += static_cast<int64_t>(best[c]);
+        q.erase(q.begin(), q.begin() + static_cast<std::ptrdiff_t>(best[c]));
+    }
+
+    if (m_policy == PairingPolicy::DropOnSkew && tMax - tMin > m_maxSkewNs) {
+        /* The anchor frame has no partner set within tolerance; the others
+           stay queued for the anchor camera's next frame. */
+        m_queues[anchor].pop_front();
+        ++m_dropped;
+        return false;
+    }
+
+    for (size_t c = 0; c < n; ++c) {
+        out[c] = std::move(m_queues[c].front());
+        m_queues[c].pop_front();
+    }
+    skewNs = tMax - tMin;
+    return true;
+}
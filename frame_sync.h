@@ -0,0 +1,70 @@
+#ifndef FRAME_SYNC_H
+#define FRAME_SYNC_H
+
+#include <opencv2/core.hpp>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+enum class PairingPolicy { Nearest, LatestOfEach, DropOnSkew };
+
+struct TimedFrame {
+    cv::Mat image;
+    int64_t timestampNs = 0;
+    int64_t seq = 0;
+    uint32_t exposureGen = 0;
+    std::shared_ptr<void> owner;
+};
+
+int64_t monotonicNowNs();
+
+/* Frames of one camera that may hold a capture buffer through `owner` at
+   the same time: kMaxPinnedQueued waiting in FrameSync (later ones are
+   copied out on push) plus the set the worker is processing. Backends with
+   a fixed buffer pool keep it larger than this plus their own queue. */
+constexpr size_t kMaxPinnedQueued = 1;
+constexpr size_t kMaxPinnedFrames = kMaxPinnedQueued + 1;
+
+/* Collects timestamped frames from the per-camera capture threads and hands
+   out matched sets, one frame per camera. Each camera keeps at most `depth`
+   frames; the oldest is dropped when a capture thread outruns the consumer,
+   unless the sync is lossless (offline sources), in which case push()
+   blocks instead. skewNs of a set is the spread between its earliest and
+   latest timestamp. Zero-copy frames beyond kMaxPinnedQueued per camera
+   are detached (cloned, owner released) before they are queued. */
+class FrameSync {
+public:
+    explicit FrameSync(size_t depth = 4);
+
+    void setCameraCount(int count);
+    int cameraCount() const;
+    void push(int cam, TimedFrame frame);
+    bool waitSet(std::vector<TimedFrame>& out, int64_t& skewNs, int timeoutMs);
+    void setPolicy(PairingPolicy policy, int64_t maxSkewNs);
+    void setLossless(bool lossless);
+    void clear();
+    void wake();
+
+    int64_t droppedFrames() const;
+    /* Queued frames as a fraction of capacity (0..1). */
+    double fill() const;
+
+private:
+    bool trySetLocked(std::vector<TimedFrame>& out, int64_t& skewNs);
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::vector<std::deque<TimedFrame>> m_queues;
+    size_t m_depth;
+    PairingPolicy m_policy = PairingPolicy::Nearest;
+    int64_t m_maxSkewNs = 8000000;
+    int64_t m_dropped = 0;
+    bool m_lossless = false;
+    bool m_woken = false;
+};
+
+#endif // FRAME_SYNC_H
@@ -0,0 +1,216 @@
+#include "gst_capture.h"
+#include "frame_sync.h"
+
+#ifdef DUALCAM_HAVE_GST_APP
+#include <gst/gst.h>
+#include <gst/app/gstappsink.h>
+#include <gst/video/video.h>
+#include <opencv2/imgproc.hpp>
+#include <iostream>
+#include <locale>
+#include <mutex>
+#include <sstream>
+#endif
+
+struct GstAppSinkCapture::Impl {
+#ifdef DUALCAM_HAVE_GST_APP
+    GstElement* pipeline = nullptr;
+    GstAppSink* sink = nullptr;
+#endif
+};
+
+GstAppSinkCapture::GstAppSinkCapture()
+    : m_impl(new Impl)
+{
+}
+
+GstAppSinkCapture::~GstAppSinkCapture()
+{
+    release();
+}
+
+#ifdef DUALCAM_HAVE_GST_APP
+
+namespace {
+    /* Samples held in gray mode stay mapped, and with them a buffer of the
+       source's pool: one queued in the appsink plus kMaxPinnedFrames in the
+       application, three per camera, which leaves libcamerasrc at least one
+       of its default four buffers to capture into. */
+    constexpr guint kAppSinkBuffers = 1;
+
+    struct MappedSample {
+        GstSample* sample = nullptr;
+        GstVideoFrame frame;
+    };
+
+    void releaseMappedSample(void* p)
+    {
+        auto* m = static_cast<MappedSample*>(p);
+        gst_video_frame_unmap(&m->frame);
+        gst_sample_unref(m->sample);
+        delete m;
+    }
+
+    bool setIfPresent(GstElement* e, const char* name, const std::string& value)
+    {
+        if (!g_object_class_find_property(G_OBJECT_GET_CLASS(e), name)) return false;
+        gst_util_set_object_arg(G_OBJECT(e), name, value.c_str());
+        return true;
+    }
+
+    /* Qt applies the user locale to the C library; property strings must
+       use '.' as the decimal separator regardless. */
+    std::string formatNumber(double v)
+    {
+        std::ostringstream os;
+        os.imbue(std::locale::classic());
+        os << v;
+        return os.str();
+    }
+}
+
+bool GstAppSinkCapture::available()
+{
+    static std::once_flag once;
+    static bool ok = false;
+    std::call_once(once, []() { ok = gst_init_check(nullptr, nullptr, nullptr); });
+    return ok;
+}
+
+bool GstAppSinkCapture::open(const std::string& pipeline)
+{
+    release();
+    if (!available()) return false;
+
+    GError* err = nullptr;
+    GstElement* pipe = gst_parse_launch(pipeline.c_str(), &err);
+    if (err) {
+        std::cerr << "[gst] " << err->message << std::endl;
+        g_clear_error(&err);
+        if (pipe) gst_object_unref(pipe);
+        return false;
+    }
+    if (!pipe) return false;
+
+    GstElement* sink = gst_bin_get_by_name(GST_BIN(pipe), "sink");
+    if (!sink) {
+        std::cerr << "[gst] pipeline has no appsink named 'sink'" << std::endl;
+        gst_object_unref(pipe);
+        return false;
+    }
+    m_impl->pipeline = pipe;
+    m_impl->sink = GST_APP_SINK(sink);
+    gst_app_sink_set_max_buffers(m_impl->sink, kAppSinkBuffers);
+    gst_app_sink_set_drop(m_impl->sink, TRUE);
+
+    if (gst_element_set_state(pipe, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+        release();
+        return false;
+    }
+    return true;
+}
+
+void GstAppSinkCapture::release()
+{
+    if (!m_impl || !m_impl->pipeline) return;
+    gst_element_set_state(m_impl->pipeline, GST_STATE_NULL);
+    gst_object_unref(m_impl->sink);
+    gst_object_unref(m_impl->pipeline);
+    m_impl->sink = nullptr;
+    m_impl->pipeline = nullptr;
+}
+
+bool GstAppSinkCapture::isOpened() const
+{
+    return m_impl && m_impl->pipeline;
+}
+
+bool GstAppSinkCapture::setExposure(bool manual, double gain, int shutterUs)
+{
+    if (!isOpened()) return false;
+    GstElement* src = gst_bin_get_by_name(GST_BIN(m_impl->pipeline), "src");
+    if (!src) return false;
+
+    bool ok = setIfPresent(src, "ae-enable", manual ? "false" : "true");
+    if (ok && manual) {
+        setIfPresent(src, "exposure-time-mode", "manual");
+        setIfPresent(src, "analogue-gain-mode", "manual");
+        ok = setIfPresent(src, "exposure-time", std::to_string(shutterUs))
+          && setIfPresent(src, "analogue-gain", formatNumber(gain));
+    }
+    gst_object_unref(src);
+    return ok;
+}
+
+bool GstAppSinkCapture::read(cv::Mat& out, std::shared_ptr<void>& owner, int64_t& timestampNs,
+                             bool color, int timeoutMs)
+{
+    if (!isOpened()) return false;
+    GstSample* sample = gst_app_sink_try_pull_sample(m_impl->sink,
+        static_cast<GstClockTime>(timeoutMs) * GST_MSECOND);
+    if (!sample) return false;
+
+    GstVideoInfo info;
+    GstCaps* caps = gst_sample_get_caps(sample);
+    GstBuffer* buf = gst_sample_get_buffer(sample);
+    if (!caps || !buf || !gst_video_info_from_caps(&info, caps)) {
+        gst_sample_unref(sample);
+        return false;
+    }
+
+    auto* mapped = new MappedSample;
+    mapped->sample = sample;
+    if (!gst_video_frame_map(&mapped->frame, &info, buf, GST_MAP_READ)) {
+        gst_sample_unref(sample);
+        delete mapped;
+        return false;
+    }
+    std::shared_ptr<void> hold(mapped, releaseMappedSample);
+
+    /* The default pipeline clock is the monotonic system clock, the same
+       domain as monotonicNowNs(), so base_time + PTS is the capture instant. */
+    const GstClockTime pts = GST_BUFFER_PTS(buf);
+    if (GST_CLOCK_TIME_IS_VALID(pts)) {
+        timestampNs = static_cast<int64_t>(gst_element_get_base_time(m_impl->pipeline) + pts);
+    } else {
+        timestampNs = monotonicNowNs();
+    }
+
+    GstVideoFrame& vf = mapped->frame;
+    const int w = GST_VIDEO_FRAME_WIDTH(&vf);
+    const int h = GST_VIDEO_FRAME_HEIGHT(&vf);
+    const GstVideoFormat fmt = GST_VIDEO_FRAME_FORMAT(&vf);
+    if (fmt != GST_VIDEO_FORMAT_NV12 && fmt != GST_VIDEO_FORMAT_GRAY8
+        && fmt != GST_VIDEO_FORMAT_GRAY16_LE) return false;
+
+    const int planeType = (fmt == GST_VIDEO_FORMAT_GRAY16_LE) ? CV_16UC1 : CV_8UC1;
+    cv::Mat y(h, w, planeType, GST_VIDEO_FRAME_PLANE_DATA(&vf, 0),
+              static_cast<size_t>(GST_VIDEO_FRAME_PLANE_STRIDE(&vf, 0)));
+
+    if (!color) {
+        out = y;
+        owner = std::move(hold);
+        return true;
+    }
+
+    if (fmt == GST_VIDEO_FORMAT_NV12) {
+        cv::Mat uv(h / 2, w / 2, CV_8UC2, GST_VIDEO_FRAME_PLANE_DATA(&vf, 1),
+                   static_cast<size_t>(GST_VIDEO_FRAME_PLANE_STRIDE(&vf, 1)));
+        cv::cvtColorTwoPlane(y, uv, out, cv::COLOR_YUV2BGR_NV12);
+    } else {
+        cv::cvtColor(y, out, cv::COLOR_GRAY2BGR);
+    }
+    owner.reset();
+    return true;
+}
+
+#else
+
+bool GstAppSinkCapture::available() { return false; }
+bool GstAppSinkCapture::open(const std::string&) { return false; }
+void GstAppSinkCapture::release() {}
+bool GstAppSinkCapture::isOpened() const { return false; }
+bool GstAppSinkCapture::read(cv::Mat&, std::shared_ptr<void>&, int64_t&, bool, int) { return false; }
+bool GstAppSinkCapture::setExposure(bool, double, int) { return false; }
+
+#endif
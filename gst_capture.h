@@ -0,0 +1,39 @@
+#ifndef GST_CAPTURE_H
+#define GST_CAPTURE_H
+
+#include <opencv2/core.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/* Pulls NV12 / GRAY8 / GRAY16_LE samples straight from an appsink named
+   "sink" (GRAY16_LE arrives as CV_16U). In gray modes the Y plane is handed
+   out as a cv::Mat view on the mapped GstBuffer; `owner` keeps the sample
+   mapped for as long as it is held, so the view must be treated as
+   read-only and must not outlive `owner`.
+   BGR is produced (one NV12->BGR pass) only when `color` is requested. */
+class GstAppSinkCapture {
+public:
+    GstAppSinkCapture();
+    ~GstAppSinkCapture();
+    GstAppSinkCapture(const GstAppSinkCapture&) = delete;
+    GstAppSinkCapture& operator=(const GstAppSinkCapture&) = delete;
+
+    static bool available();
+
+    bool open(const std::string& pipeline);
+    void release();
+    bool isOpened() const;
+    bool read(cv::Mat& out, std::shared_ptr<void>& owner, int64_t& timestampNs,
+              bool color, int timeoutMs = 500);
+    /* Pushes exposure controls into the running element named "src"
+       (libcamerasrc). False when it has no such properties. */
+    bool setExposure(bool manual, double gain, int shutterUs);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+#endif // GST_CAPTURE_H
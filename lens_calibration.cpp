@@ -0,0 +1,76 @@
+#include "lens_calibration.h"
+
+#include <opencv2/calib3d.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <cmath>
+#include <iostream>
+
+namespace {
+    /* Solutions with a larger reprojection error come from blurred or
+       misdetected views and would add distortion rather than remove it. */
+    constexpr double kMaxRmsPx = 1.5;
+}
+
+LensModel LensModel::scaledTo(const cv::Size& size) const
+{
+    if (!valid() || size == imageSize) return *this;
+    const double sx = static_cast<double>(size.width) / imageSize.width;
+    const double sy = static_cast<double>(size.height) / imageSize.height;
+    if (std::abs(sx - sy) > 0.01) return LensModel();
+
+    LensModel out = *this;
+    out.cameraMatrix = cameraMatrix.clone();
+    out.cameraMatrix.at<double>(0, 0) *= sx;
+    out.cameraMatrix.at<double>(0, 2) *= sx;
+    out.cameraMatrix.at<double>(1, 1) *= sy;
+    out.cameraMatrix.at<double>(1, 2) *= sy;
+    out.imageSize = size;
+    return out;
+}
+
+bool findLensTarget(const cv::Mat& gray8, std::vector<cv::Point2f>& corners)
+{
+    const cv::Size pattern(kLensBoardCols, kLensBoardRows);
+    const int flags = cv::CALIB_CB_ADAPTIVE_THRESH | cv::CALIB_CB_NORMALIZE_IMAGE | cv::CALIB_CB_FAST_CHECK;
+    if (!cv::findChessboardCorners(gray8, pattern, corners, flags)) return false;
+    cv::cornerSubPix(gray8, corners, cv::Size(11, 11), cv::Size(-1, -1),
+                     cv::TermCriteria(cv::TermCriteria::EPS | cv::TermCriteria::COUNT, 30, 0.01));
+    return true;
+}
+
+bool solveLens(const std::vector<std::vector<cv::Point2f>>& views, const cv::Size& imageSize, LensModel& out)
+{
+    if (static_cast<int>(views.size()) < kLensViewsNeeded) return false;
+
+    /* Square size only scales the extrinsics, so the board is in units of
+       one square. */
+    std::vector<cv::Point3f> board;
+    for (int r = 0; r < kLensBoardRows; ++r)
+        for (int c = 0; c < kLensBoardCols; ++c)
+            board.emplace_back(static_cast<float>(c), static_cast<float>(r), 0.0f);
+    const std::vector<std::vector<cv::Point3f>> objectPoints(views.size(), board);
+
+    LensModel lens;
+    lens.imageSize = imageSize;
+    std::vector<cv::Mat> rvecs, tvecs;
+    lens.rms = cv::calibrateCamera(objectPoints, views, imageSize, lens.cameraMatrix, lens.distCoeffs,
+                                   rvecs, tvecs);
+    std::cerr << "[lens] rms " << lens.rms << " px, K =\n" << lens.cameraMatrix
+              << "\n  dist " << lens.distCoeffs << std::endl;
+    if (!std::isfinite(lens.rms) || lens.rms > kMaxRmsPx) return false;
+    out = lens;
+    return true;
+}
+
+void undistortMaps(const LensModel& lens, const cv::Size& size, cv::Mat& mapX, cv::Mat& mapY)
+{
+    const LensModel l = lens.scaledTo(size);
+    if (!l.valid()) {
+        mapX.release();
+        mapY.release();
+        return;
+    }
+    cv::initUndistortRectifyMap(l.cameraMatrix, l.distCoeffs, cv::noArray(), l.cameraMatrix,
+                                size, CV_32FC1, mapX, mapY);
+}
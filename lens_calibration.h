@@ -0,0 +1,36 @@
+#ifndef LENS_CALIBRATION_H
+#define LENS_CALIBRATION_H
+
+#include <opencv2/core.hpp>
+
+#include <vector>
+
+/* Inner-corner grid of the printed chessboard target and the number of
+   distinct poses collected before the intrinsics are solved. */
+constexpr int kLensBoardCols = 9;
+constexpr int kLensBoardRows = 6;
+constexpr int kLensViewsNeeded = 10;
+
+/* Pinhole intrinsics plus the 5-term radial/tangential distortion
+   (k1, k2, p1, p2, k3) of one camera, solved at imageSize. */
+struct LensModel {
+    cv::Mat cameraMatrix;
+    cv::Mat distCoeffs;
+    cv::Size imageSize;
+    double rms = 0.0;
+
+    bool valid() const { return !cameraMatrix.empty() && !distCoeffs.empty() && imageSize.area() > 0; }
+    /* The same lens at another resolution with the same aspect ratio
+       (binned or scaled sensor modes); an invalid model otherwise. */
+    LensModel scaledTo(const cv::Size& size) const;
+};
+
+bool findLensTarget(const cv::Mat& gray8, std::vector<cv::Point2f>& corners);
+bool solveLens(const std::vector<std::vector<cv::Point2f>>& views, const cv::Size& imageSize, LensModel& out);
+
+/* Float maps from undistorted pixel to raw pixel. The undistorted view
+   keeps the original camera matrix, so scale and centre do not move and a
+   homography solved on it stays meaningful. */
+void undistortMaps(const LensModel& lens, const cv::Size& size, cv::Mat& mapX, cv::Mat& mapY);
+
+#endif // LENS_CALIBRATION_H
@@ -1,6 +1,9 @@
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QMessageBox>
 #include <QScreen>
 #include <QIcon>
+#include <QTimer>
 #include "mainwindow.h"
 
 
@@ -11,8 +14,63 @@ int main(int argc, char* argv[])
     QApplication app(argc, argv);
     app.setWindowIcon(QIcon(":/icon.ico"));
 
+    QCommandLineParser parser;
+    parser.setApplicationDescription("DualCam analysis tool");
+    parser.addHelpOption();
+    QCommandLineOption sourceOpt("source",
+        "Frame source: live | files | synthetic", "kind", "live");
+    QCommandLineOption filesOpt("files",
+        "Recordings for --source files, one per camera: <cam1>,<cam2>[,...] (video files or image-sequence patterns)", "paths");
+    QCommandLineOption camerasOpt("cameras",
+        QString("Number of synchronized cameras, 2..%1 (live and synthetic)").arg(kMaxCameras), "n", "2");
+    QCommandLineOption synthOpt("synthetic",
+        "Synthetic generator: noise=4,motion=1.5,dx=6,dy=-3,blur=1,seed=1,depth=8|16", "spec");
+    QCommandLineOption rateOpt("rate",
+        "Offline replay rate in FPS (0 = as fast as possible)", "fps", "0");
+    QCommandLineOption noLoopOpt("no-loop", "Stop recorded replay at the end of the files");
+    QCommandLineOption autostartOpt("autostart", "Start streaming immediately");
+    parser.addOption(sourceOpt);
+    parser.addOption(filesOpt);
+    parser.addOption(camerasOpt);
+    parser.addOption(synthOpt);
+    parser.addOption(rateOpt);
+    parser.addOption(noLoopOpt);
+    parser.addOption(autostartOpt);
+    parser.process(app);
+
+    SourceSpec spec;
+    bool camerasOk = false;
+    spec.cameras = parser.value(camerasOpt).toInt(&camerasOk);
+    if (!camerasOk || spec.cameras < 2 || spec.cameras > kMaxCameras) {
+        QMessageBox::critical(nullptr, "DualCam", QString("--cameras must be 2..%1").arg(kMaxCameras));
+        return 1;
+    }
+    const QString kind = parser.value(sourceOpt);
+    if (kind == "files") {
+        const QStringList paths = parser.value(filesOpt).split(',');
+        if (paths.size() < 2 || paths.size() > kMaxCameras || paths.contains(QString())) {
+            QMessageBox::critical(nullptr, "DualCam",
+                QString("--source files needs --files <cam1>,<cam2>[,...] (up to %1)").arg(kMaxCameras));
+            return 1;
+        }
+        spec.kind = SourceKind::Files;
+        for (const QString& path : paths) spec.paths.push_back(path.toStdString());
+    } else if (kind == "synthetic") {
+        spec.kind = SourceKind::Synthetic;
+        if (parser.isSet(synthOpt) && !parseSyntheticParams(parser.value(synthOpt).toStdString(), spec.synth)) {
+            QMessageBox::critical(nullptr, "DualCam", "Invalid --synthetic spec: " + parser.value(synthOpt));
+            return 1;
+        }
+    } else if (kind != "live") {
+        QMessageBox::critical(nullptr, "DualCam", "Unknown --source: " + kind);
+        return 1;
+    }
+    spec.rateFps = parser.value(rateOpt).toDouble();
+    spec.loop = !parser.isSet(noLoopOpt);
+
     MainWindow w;
     w.setWindowTitle("DualCam");
+    if (spec.kind != SourceKind::Live || parser.isSet(camerasOpt)) w.setSourceSpec(spec);
 
     QScreen* screen = QApplication::primaryScreen();
     QSize screenSize = screen->availableSize();
@@ -23,5 +81,9 @@ int main(int argc, char* argv[])
         w.show();
     }
 
+    if (parser.isSet(autostartOpt)) {
+        QTimer::singleShot(0, &w, [&w]() { w.executeCommand("cmd_stream"); });
+    }
+
     return app.exec();
 }
@@ -1,4 +1,5 @@
 #include "mainwindow.h"
+#include "gst_capture.h"
 #ifndef DUALCAM_SEPARATE_VIEWER
 #include "viewer_dialogs.h"
 #endif
@@ -18,6 +19,8 @@
 #include <QPushButton>
 #include <QTimer>
 #include <QImage>
+#include <QImageReader>
+#include <QImageWriter>
 #include <QPixmap>
 #include <QStatusBar>
 #include <QComboBox>
@@ -31,6 +34,7 @@
 #include <QDir>
 #include <QFileInfo>
 #include <QDateTime>
+#include <QCryptographicHash>
 #include <QGroupBox>
 #include <QTabWidget>
 #include <QScrollArea>
@@ -63,6 +67,7 @@
 #include <QtCharts/QValueAxis>
 #include <QtCharts/QChart>
 #include <QtCharts/QLegend>
+#include <QtCharts/QLegendMarker>
 #include <QScreen>
 #include <QStandardPaths>
 #include <QThread>
@@ -72,10 +77,10 @@
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/video.hpp>
 #include <opencv2/core/utility.hpp>
-#include <opencv2/features2d.hpp>
-#include <opencv2/flann.hpp>
 #include <opencv2/calib3d.hpp>
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <vector>
 #include <cmath>
@@ -210,48 +215,146 @@ void GpuImageView::paintGL()
 }
 
 CameraWorker::CameraWorker(QObject* parent) : QThread(parent) {
-    m_bgSubtractor = cv::createBackgroundSubtractorMOG2(500, 16.0, false);
+    std::cerr << "[denoise] temporal EMA kernel: " << temporalEmaKernel() << std::endl;
 }
 CameraWorker::~CameraWorker() {
     stopCameras();
 }
-void CameraWorker::startCameras(const std::string& pipe1, const std::string& pipe2, int w, int h, int fps) {
-    m_cap1.open(pipe1, cv::CAP_GSTREAMER);
-    m_cap2.open(pipe2, cv::CAP_GSTREAMER);
-    if (!m_cap1.isOpened() || !m_cap2.isOpened()) {
-        emit cameraError("Failed to open GStreamer pipelines");
-        return;
+void CameraWorker::startCameras(const std::vector<std::string>& pipes, int fps) {
+    std::vector<std::unique_ptr<FrameSource>> sources;
+    for (const std::string& pipe : pipes) {
+        sources.push_back(makeGStreamerSource(pipe));
+        if (!sources.back()) {
+            emit cameraError("Failed to open GStreamer pipelines");
+            return;
+        }
     }
-    m_running = true;
-    start();
+    startSources(std::move(sources), fps);
 }
-void CameraWorker::startCamerasV4L2(int id1, int id2, int w, int h, int fps) {
-#ifdef Q_OS_LINUX
-    m_cap1.open(id1, cv::CAP_V4L2);
-    m_cap2.open(id2, cv::CAP_V4L2);
-#else
-    m_cap1.open(id1, cv::CAP_DSHOW);
-    m_cap2.open(id2, cv::CAP_DSHOW);
-#endif
-    if (!m_cap1.isOpened() || !m_cap2.isOpened()) {
-        emit cameraError("Failed to open one or both cameras (V4L2/DSHOW fallback)");
-        if (m_cap1.isOpened()) m_cap1.release();
-        if (m_cap2.isOpened()) m_cap2.release();
+void CameraWorker::startCamerasV4L2(const QList<int>& ids, int w, int h, int fps, bool highBitDepth) {
+    std::vector<std::unique_ptr<FrameSource>> sources;
+    for (int id : ids) {
+        sources.push_back(makeDeviceSource(id, w, h, fps, highBitDepth));
+        if (!sources.back()) {
+            emit cameraError(QString("Failed to open camera %1 (V4L2/DSHOW fallback)").arg(id));
+            return;
+        }
+    }
+    startSources(std::move(sources), fps);
+}
+bool CameraWorker::startCamerasNative(const std::vector<std::string>& pipes, int fps) {
+    std::vector<std::unique_ptr<FrameSource>> sources;
+    for (const std::string& pipe : pipes) {
+        sources.push_back(makeAppSinkSource(pipe));
+        if (!sources.back()) return false;
+    }
+    startSources(std::move(sources), fps);
+    return true;
+}
+void CameraWorker::startSources(std::vector<std::unique_ptr<FrameSource>> sources, int fps) {
+    const bool valid = sources.size() >= 2 && sources.size() <= static_cast<size_t>(kMaxCameras)
+        && std::all_of(sources.begin(), sources.end(), [](const auto& s) { return s != nullptr; });
+    if (!valid) {
+        emit cameraError("Failed to open frame sources");
         return;
     }
-    m_cap1.set(cv::CAP_PROP_FRAME_WIDTH, w);
-    m_cap1.set(cv::CAP_PROP_FRAME_HEIGHT, h);
-    m_cap1.set(cv::CAP_PROP_FPS, fps);
-    m_cap2.set(cv::CAP_PROP_FRAME_WIDTH, w);
-    m_cap2.set(cv::CAP_PROP_FRAME_HEIGHT, h);
-    m_cap2.set(cv::CAP_PROP_FPS, fps);
+    m_sources = std::move(sources);
+    const int n = static_cast<int>(m_sources.size());
+    m_frameIntervalNs = fps > 0 ? 1000000000LL / fps : 0;
+    m_sync.clear();
+    m_sync.setCameraCount(n);
+    m_sync.setLossless(std::none_of(m_sources.begin(), m_sources.end(),
+                                    [](const auto& s) { return s->isLive(); }));
+    m_mailbox.reset();
+    m_notifyPending = false;
+    m_camState.assign(n, CameraState());
+    m_stages.resize(n);
+    m_paramMutex.lock();
+    m_sync.setPolicy(m_params.pairingPolicy, static_cast<int64_t>(m_params.maxSkewMs) * 1000000);
+    m_paramMutex.unlock();
     m_running = true;
+    for (int cam = 0; cam < n; ++cam) {
+        m_grabThreads.emplace_back([this, cam]() { captureLoop(cam); });
+    }
     start();
 }
+/* Per-camera watchdog. A live stream that delivers nothing for
+   kStallIntervals frame intervals (at least kMinStallMs) is declared
+   stalled and reopened with exponential backoff until it comes back.
+   Failed reads never spin: a backend that fails immediately (unplugged
+   device, EOS) is paused for one frame interval before the next try.
+   Only the source is touched, so EMA, alignment and the pairing policy
+   survive the reconnect. */
+namespace {
+    constexpr int64_t kStallIntervals = 10;
+    constexpr int64_t kMinStallMs = 1000;
+    constexpr int kReopenBackoffMinMs = 250;
+    constexpr int kReopenBackoffMaxMs = 8000;
+    constexpr int kFailPauseMaxMs = 50;
+}
+bool CameraWorker::pauseCapture(int ms) {
+    /* Sliced so stopCameras() is never held up by a long backoff. */
+    const auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+    while (m_running && std::chrono::steady_clock::now() < until) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(std::min(ms, 20)));
+    }
+    return m_running;
+}
+void CameraWorker::captureLoop(int cam) {
+    FrameSource* src = m_sources[cam].get();
+    const QString name = QString("CAM%1 (%2)").arg(cam + 1).arg(QString::fromStdString(src->describe()));
+    const int64_t stallNs = std::max(kStallIntervals * m_frameIntervalNs, kMinStallMs * 1000000);
+    const int failPauseMs = m_frameIntervalNs > 0
+        ? static_cast<int>(std::min<int64_t>(m_frameIntervalNs / 1000000, kFailPauseMaxMs))
+        : kFailPauseMaxMs;
+    int64_t lastFrameNs = monotonicNowNs();
+    int backoffMs = kReopenBackoffMinMs;
+    bool stalled = false;
+
+    while (m_running) {
+        TimedFrame tf;
+        if (src->read(tf, m_captureColor)) {
+            lastFrameNs = monotonicNowNs();
+            if (stalled) {
+                stalled = false;
+                backoffMs = kReopenBackoffMinMs;
+                std::cerr << "[watchdog] " << name.toStdString() << " recovered" << std::endl;
+                emit cameraError(QString("%1 reconnected").arg(name));
+                emit cameraStalled(cam, false);
+            }
+            m_sync.push(cam, std::move(tf));
+            continue;
+        }
+        if (src->finished()) {
+            emit cameraError(QString("End of stream: %1").arg(QString::fromStdString(src->describe())));
+            break;
+        }
+
+        const int64_t silentNs = monotonicNowNs() - lastFrameNs;
+        if (!src->isLive() || silentNs < stallNs) {
+            if (!pauseCapture(failPauseMs)) break;
+            continue;
+        }
+
+        if (!stalled) {
+            stalled = true;
+            std::cerr << "[watchdog] " << name.toStdString() << " stalled for "
+                      << silentNs / 1000000 << " ms, reconnecting" << std::endl;
+            emit cameraError(QString("%1 stalled, reconnecting...").arg(name));
+            emit cameraStalled(cam, true);
+        }
+        if (!pauseCapture(backoffMs)) break;
+        if (src->reopen()) {
+            /* Give the new stream a full stall window before judging it. */
+            lastFrameNs = monotonicNowNs();
+        } else {
+            backoffMs = std::min(backoffMs * 2, kReopenBackoffMaxMs);
+        }
+    }
+}
 void CameraWorker::stopCameras() {
     m_running = false;
-    if (m_cap1.isOpened()) m_cap1.release();
-    if (m_cap2.isOpened()) m_cap2.release();
+    m_sync.wake();
     if (!wait(2000)) {
         requestInterruption();
         if (!wait(1000)) {
@@ -259,34 +362,66 @@ void CameraWorker::stopCameras() {
             wait();
         }
     }
+    for (std::thread& t : m_grabThreads) {
+        if (t.joinable()) t.join();
+    }
+    m_grabThreads.clear();
+    m_sync.clear();
+    for (auto& src : m_sources) src->close();
+    m_sources.clear();
 }
 void CameraWorker::setParams(const WorkerParams& p) {
     m_paramMutex.lock();
     m_params = p;
     m_paramMutex.unlock();
+    m_captureColor = (p.colorMode == ColorMode::COLOR);
+    m_sync.setPolicy(p.pairingPolicy, static_cast<int64_t>(p.maxSkewMs) * 1000000);
+}
+uint32_t CameraWorker::applyExposure(const std::vector<ExposureSettings>& e) {
+    if (!m_running || m_sources.empty() || e.size() < m_sources.size()) return 0;
+    const uint32_t gen = ++m_exposureGen;
+    m_paramMutex.lock();
+    m_exposureHistory.push_back({ gen, e });
+    while (m_exposureHistory.size() > kExposureHistory) m_exposureHistory.pop_front();
+    m_paramMutex.unlock();
+    bool ok = true;
+    for (size_t c = 0; c < m_sources.size(); ++c) {
+        ok = m_sources[c]->setExposure(e[c], gen) && ok;
+    }
+    return ok ? gen : 0;
+}
+void CameraWorker::resetExposure(const std::vector<ExposureSettings>& e) {
+    /* Generation 0 is whatever the stream was opened with. */
+    m_paramMutex.lock();
+    m_exposureGen = 0;
+    m_exposureHistory.clear();
+    m_exposureHistory.push_back({ 0, e });
+    m_paramMutex.unlock();
+}
+bool CameraWorker::takeLatest(FramePacket& out) {
+    /* Clear before fetching: a pair published after the fetch re-arms the
+       notification, so the GUI can never miss the last frame. */
+    m_notifyPending = false;
+    if (!m_mailbox.fetch()) return false;
+    out = m_mailbox.readSlot();
+    return true;
 }
 cv::Mat CameraWorker::toWorkingFormat(const cv::Mat& frame, ColorMode mode) {
     if (frame.empty()) return frame;
     cv::Mat res;
-    if (mode == ColorMode::GRAY_CV) {
-        if (frame.channels() == 3) cv::cvtColor(frame, res, cv::COLOR_BGR2GRAY);
-        else res = frame.clone();
+    if (mode == ColorMode::COLOR) {
+        if (frame.channels() == 1) cv::cvtColor(frame, res, cv::COLOR_GRAY2BGR);
+        else res = frame;
     } else {
-        if (frame.channels() == 1 && mode == ColorMode::COLOR) cv::cvtColor(frame, res, cv::COLOR_GRAY2BGR);
-        else res = frame.clone();
+        if (frame.channels() == 3) cv::cvtColor(frame, res, cv::COLOR_BGR2GRAY);
+        else res = frame;
     }
     return res;
 }
-double CameraWorker::detectMotion(const cv::Mat& frame, double /*thr*/) {
-
-    if (frame.empty()) return 0.0;
-    cv::Mat fgMask;
-    m_bgSubtractor->apply(frame, fgMask, 0.01);
-    double nonZero = cv::countNonZero(fgMask);
-    return nonZero / (frame.cols * frame.rows);
-}
-cv::Mat CameraWorker::applyTemporalDenoise(cv::Mat& frame, cv::Mat& ema, int bufferSize) {
+cv::Mat CameraWorker::applyTemporalDenoise(cv::Mat& frame, TemporalEmaState& state, int bufferSize) {
     if (bufferSize <= 1 || frame.empty()) return frame;
+    if (temporalEmaSupported(frame.depth())) return temporalEma(frame, state, bufferSize);
+    cv::Mat& ema = state.acc;
     double alpha = 1.0 / static_cast<double>(bufferSize);
     int cvType = (frame.channels() == 3) ? CV_32FC3 : CV_32F;
     if (ema.empty() || ema.size() != frame.size() || ema.type() != cvType) {
@@ -300,73 +435,642 @@ cv::Mat CameraWorker::applyTemporalDenoise(cv::Mat& frame, cv::Mat& ema, int buf
     ema.convertTo(res, frame.type());
     return res;
 }
-double CameraWorker::calculateFocus(const cv::Mat& frame) {
-    if (frame.empty()) return 0.0;
-    cv::Mat gray;
-    if (frame.channels() == 3) cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
-    else gray = frame;
-    cv::Mat laplacian;
-    cv::Laplacian(gray, laplacian, CV_64F);
-    cv::Scalar mean, stddev;
-    cv::meanStdDev(laplacian, mean, stddev);
-    return stddev.val[0] * stddev.val[0];
+namespace {
+    /* bilateralFilter has no 16-bit kernel: 16-bit frames are filtered in
+       float with the colour sigma scaled to the 16-bit range. */
+    cv::Mat bilateralDenoise(const cv::Mat& f, int strength) {
+        const int depth = f.depth();
+        if (depth != CV_8U && depth != CV_16U && depth != CV_32F) return f;
+        int s = std::max(1, std::min(20, strength));
+        int d = (s % 2 == 0) ? s + 1 : s;
+        double sigma = 10.0 * s;
+        cv::Mat b;
+        if (depth == CV_16U) {
+            cv::Mat g;
+            f.convertTo(g, CV_32F);
+            cv::bilateralFilter(g, b, d, sigma * kStep16, sigma);
+            b.convertTo(b, CV_16U);
+        } else {
+            cv::bilateralFilter(f, b, d, sigma, sigma);
+        }
+        return b;
+    }
+}
+namespace {
+    /* Frame rings of all cameras together. 16 gray 1080p frames are 33 MB
+       per camera, 16-bit colour ones six times that. */
+    constexpr int64_t kTemporalBudgetBytes = 256LL * 1024 * 1024;
 }
 void CameraWorker::run() {
-    cv::Mat f1, f2;
+    std::vector<TimedFrame> set;
+    std::vector<cv::Mat> frames;
+    int64_t skewNs = 0;
     while (m_running) {
-        if (!m_cap1.grab() || !m_cap2.grab()) continue;
-        m_cap1.retrieve(f1);
-        m_cap2.retrieve(f2);
-
-        if (f1.empty() || f2.empty()) continue;
-
+        if (!m_sync.waitSet(set, skewNs, 100)) continue;
+        StageMeter::Scope busy(m_meter);
+        const int n = static_cast<int>(set.size());
+        if (n != static_cast<int>(m_camState.size())) continue;
+        if (std::any_of(set.begin(), set.end(), [](const TimedFrame& t) { return t.image.empty(); })) continue;
+        const double skewMs = skewNs / 1e6;
+
+        auto meta = std::make_shared<FrameMeta>();
+        meta->cams.resize(n);
         m_paramMutex.lock();
         WorkerParams p = m_params;
+        for (int c = 0; c < n; ++c) {
+            for (auto it = m_exposureHistory.rbegin(); it != m_exposureHistory.rend(); ++it) {
+                if (it->first <= set[c].exposureGen && c < static_cast<int>(it->second.size())) {
+                    meta->cams[c].exposure = it->second[c];
+                    break;
+                }
+            }
+        }
         m_paramMutex.unlock();
 
-        if (p.flipHor2 && p.flipVer2) cv::flip(f2, f2, -1);
-        else if (p.flipHor2) cv::flip(f2, f2, 1);
-        else if (p.flipVer2) cv::flip(f2, f2, 0);
+        /* Each camera is processed on its own stage worker. Motion detection
+           runs on every camera's worker right after its format conversion;
+           the verdict is the only thing the second stage waits for. */
+        frames.resize(n);
+        m_stages.run(n, [&](int c) {
+            cv::Mat f = set[c].image;
+            /* Out-of-place: f may be a read-only view on a mapped buffer. */
+            const CameraFlip flip = c < static_cast<int>(p.flips.size()) ? p.flips[c] : CameraFlip();
+            if (flip.hor || flip.ver) {
+                cv::Mat flipped;
+                cv::flip(f, flipped, (flip.hor && flip.ver) ? -1 : (flip.hor ? 1 : 0));
+                f = flipped;
+            }
+            frames[c] = toWorkingFormat(f, p.colorMode);
+            CameraState& st = m_camState[c];
+            if (set[c].exposureGen != st.exposureGen) st.motion.reset();
+            MotionResult m = st.motion.detect(frames[c], p.motionModel);
+            meta->cams[c].motion = m.ratio;
+            meta->cams[c].motionRegions = std::move(m.regions);
+        });
+        const bool motionDetected = std::any_of(meta->cams.begin(), meta->cams.end(),
+                                                [&](const CameraMeta& cm) { return cm.motion > p.motionThr; });
+
+        m_stages.run(n, [&](int c) {
+            CameraState& st = m_camState[c];
+            cv::Mat& f = frames[c];
+            CameraMeta& cm = meta->cams[c];
+            const bool stacked = p.temporalMode != TemporalMode::Ema;
+            /* The fixed-point EMA adapts per pixel and the frame ring only
+               restarts where this camera saw motion; the float fallback
+               starts over. */
+            if (cm.motion > p.motionThr) {
+                if (stacked) st.stack.refresh(f, cm.motionRegions);
+                else if (!temporalEmaSupported(f.depth())) st.ema.reset();
+            }
+            /* Never blend frames taken under different exposure settings. */
+            if (set[c].exposureGen != st.exposureGen) {
+                st.exposureGen = set[c].exposureGen;
+                st.ema.reset();
+                st.stack.reset();
+            }
+            if (stacked) {
+                st.ema.reset();
+                const int depth = stackDepthFor(f.size(), f.type(), p.bufferSize, kTemporalBudgetBytes / n);
+                f = st.stack.process(f, depth, p.temporalMode);
+            } else {
+                st.stack.release();
+                f = applyTemporalDenoise(f, st.ema, p.bufferSize);
+            }
+            if (p.applyBilateral) f = bilateralDenoise(f, p.bilateralStrength);
+
+            const FocusMetrics fm = measureFocus(f, p.focusGrid);
+            cm.focus       = fm.laplacian;
+            cm.tenengrad   = fm.tenengrad;
+            cm.brenner     = fm.brenner;
+            cm.focusMap    = fm.map;
+            cm.timestampNs = set[c].timestampNs;
+            cm.seq         = set[c].seq;
+            cm.exposureGen = set[c].exposureGen;
+            cm.bits        = pixelBits(f.depth());
+
+            if (set[c].owner && f.datastart == set[c].image.datastart) f = f.clone();
+        });
+        /* Nothing published aliases the capture buffers any more; hand them
+           back to the driver instead of holding them through the next
+           wait. */
+        for (TimedFrame& t : set) {
+            t.image.release();
+            t.owner.reset();
+        }
 
-        f1 = toWorkingFormat(f1, p.colorMode);
-        f2 = toWorkingFormat(f2, p.colorMode);
+        int64_t ringBytes = 0;
+        for (const CameraState& st : m_camState) ringBytes += st.stack.bytes();
+        m_temporalBytes = ringBytes;
 
-        double motion = detectMotion(f2, p.motionThr);
-        bool motionDetected = (motion > p.motionThr);
+        m_frameCount++;
 
-        if (motionDetected) {
-            m_ema1.release();
-            m_ema2.release();
+        int64_t dropped = m_sync.droppedFrames();
+        bool live = true;
+        for (const auto& src : m_sources) {
+            dropped += src->droppedFrames();
+            live = live && src->isLive();
         }
+        meta->live          = live;
+        meta->params        = p;
+        meta->motion        = motionDetected;
+        meta->frameCount    = m_frameCount;
+        meta->skewMs        = skewMs;
+        meta->droppedFrames = dropped;
+
+        /* frames are freshly produced each iteration and never written
+           again, so the slot takes the headers by reference instead of
+           cloning. */
+        FramePacket& slot = m_mailbox.writeSlot();
+        slot.frames = frames;
+        slot.meta   = std::move(meta);
+        m_mailbox.publish();
+
+        if (!m_notifyPending.exchange(true)) emit framesReady();
+    }
+}
+
+namespace {
+    /* Below this phase correlation peak the scene has too little texture or
+       overlap for a trustworthy shift, and the homography takes over. */
+    constexpr double kMinPhaseResponse = 0.1;
+    /* Shift changes below this, in reference pixels, are not applied. */
+    constexpr double kShiftDeadBandPx = 0.25;
 
-        f1 = applyTemporalDenoise(f1, m_ema1, p.bufferSize);
-        f2 = applyTemporalDenoise(f2, m_ema2, p.bufferSize);
+    cv::Matx33d buildManualHomography(const ManualAdjust& a, const cv::Size& sz)
+    {
+        const double w = sz.width;
+        const double h = sz.height;
+        const double cx = w * 0.5;
+        const double cy = h * 0.5;
+        const double f = std::max(w, h);
+
+        const double rx = a.rx * CV_PI / 180.0;
+        const double ry = a.ry * CV_PI / 180.0;
+        const double rz = a.rz * CV_PI / 180.0;
+
+        cv::Matx33d Rx(1, 0, 0,
+                       0, std::cos(rx), -std::sin(rx),
+                       0, std::sin(rx),  std::cos(rx));
+        cv::Matx33d Ry( std::cos(ry), 0, std::sin(ry),
+                        0,            1, 0,
+                       -std::sin(ry), 0, std::cos(ry));
+        cv::Matx33d Rz(std::cos(rz), -std::sin(rz), 0,
+                       std::sin(rz),  std::cos(rz), 0,
+                       0,             0,            1);
+        cv::Matx33d R = Rz * Ry * Rx;
+
+        cv::Matx33d K(f, 0, cx,
+                      0, f, cy,
+                      0, 0, 1);
+        cv::Matx33d Kinv = K.inv();
+        cv::Matx33d H3D = K * R * Kinv;
+
+        cv::Matx33d Tc1(1, 0, -cx, 0, 1, -cy, 0, 0, 1);
+        cv::Matx33d Sc(a.scale, 0, 0, 0, a.scale, 0, 0, 0, 1);
+        cv::Matx33d Tc2(1, 0,  cx, 0, 1,  cy, 0, 0, 1);
+        cv::Matx33d S = Tc2 * Sc * Tc1;
+
+        cv::Matx33d Tx(1, 0, a.tx, 0, 1, a.ty, 0, 0, 1);
+
+        return Tx * S * H3D;
+    }
+
+    /* A frame as the composer sees it before calibration: undistorted,
+       then manually adjusted. */
+    cv::Mat adjustFrame(const cv::Mat& frame, const ManualAdjust& a, const LensModel* lens)
+    {
+        cv::Mat f = frame;
+        if (lens && lens->valid()) {
+            cv::Mat mapX, mapY, undist;
+            undistortMaps(*lens, f.size(), mapX, mapY);
+            if (!mapX.empty()) {
+                cv::remap(f, undist, mapX, mapY, cv::INTER_LINEAR, cv::BORDER_CONSTANT);
+                f = undist;
+            }
+        }
+        if (a.isIdentity()) return f;
+        cv::Mat warped;
+        cv::warpPerspective(f, warped, cv::Mat(buildManualHomography(a, f.size())), f.size(), cv::INTER_LINEAR);
+        return warped;
+    }
 
-        if (p.applyBilateral) {
-            const int depth = f1.depth();
-            if (depth == CV_8U || depth == CV_32F) {
-                int s = std::max(1, std::min(20, p.bilateralStrength));
-                int d = (s % 2 == 0) ? s + 1 : s;
-                double sigma = 10.0 * s;
-                cv::Mat b1, b2;
-                cv::bilateralFilter(f1, b1, d, sigma, sigma);
-                cv::bilateralFilter(f2, b2, d, sigma, sigma);
-                f1 = b1; f2 = b2;
+    /* Fixed-point remap tables equivalent to warpPerspective(src, H, dst):
+       every destination pixel looks up its source position through H^-1.
+       With undistortion maps that position is in the undistorted image and
+       is looked up once more in them, so lens correction and warp still
+       cost a single remap per frame. */
+    void buildRemap(const cv::Matx33d& H, const cv::Size& dst, const cv::Mat& undistX, const cv::Mat& undistY,
+                    cv::Mat& map1, cv::Mat& map2)
+    {
+        const cv::Matx33d Hi = H.inv();
+        cv::Mat mapX(dst, CV_32FC1), mapY(dst, CV_32FC1);
+        cv::parallel_for_(cv::Range(0, dst.height), [&](const cv::Range& r) {
+            for (int y = r.start; y < r.end; ++y) {
+                float* mx = mapX.ptr<float>(y);
+                float* my = mapY.ptr<float>(y);
+                for (int x = 0; x < dst.width; ++x) {
+                    const double w = Hi(2, 0) * x + Hi(2, 1) * y + Hi(2, 2);
+                    if (std::abs(w) < 1e-12) {
+                        mx[x] = my[x] = -1.0f;
+                        continue;
+                    }
+                    mx[x] = static_cast<float>((Hi(0, 0) * x + Hi(0, 1) * y + Hi(0, 2)) / w);
+                    my[x] = static_cast<float>((Hi(1, 0) * x + Hi(1, 1) * y + Hi(1, 2)) / w);
+                }
             }
+        });
+        if (!undistX.empty()) {
+            /* Near the border the interpolation would blend the -1 fill into
+               real coordinates and sample pixels well inside the image. A
+               remapped validity mask marks every lookup that touched the
+               outside, and those become -1 outright. */
+            cv::Mat fusedX, fusedY, valid, outside;
+            cv::remap(undistX, fusedX, mapX, mapY, cv::INTER_LINEAR, cv::BORDER_CONSTANT, cv::Scalar(-1));
+            cv::remap(undistY, fusedY, mapX, mapY, cv::INTER_LINEAR, cv::BORDER_CONSTANT, cv::Scalar(-1));
+            cv::remap(cv::Mat::ones(undistX.size(), CV_32FC1), valid, mapX, mapY, cv::INTER_LINEAR,
+                      cv::BORDER_CONSTANT, cv::Scalar(0));
+            cv::compare(valid, 0.999, outside, cv::CMP_LT);
+            fusedX.setTo(-1.0f, outside);
+            fusedY.setTo(-1.0f, outside);
+            mapX = fusedX;
+            mapY = fusedY;
         }
+        cv::convertMaps(mapX, mapY, map1, map2, CV_16SC2);
+    }
 
-        double focus1 = calculateFocus(f1);
-        double focus2 = calculateFocus(f2);
+    /* Running mean: every camera ends up with the same weight. */
+    cv::Mat fuseCameras(const cv::Mat& ref, const std::vector<cv::Mat>& aligned)
+    {
+        /* Never in place: ref may be a frame shared with the GUI. */
+        cv::Mat out = ref;
+        int k = 1;
+        for (const cv::Mat& m : aligned) {
+            if (m.empty() || m.size() != ref.size() || m.type() != ref.type()) continue;
+            ++k;
+            cv::Mat next;
+            cv::addWeighted(out, 1.0 - 1.0 / k, m, 1.0 / k, 0.0, next);
+            out = next;
+        }
+        return out;
+    }
 
-        m_frameCount++;
+    cv::Mat diffView(const cv::Mat& d1, const cv::Mat& d2, double f1, double f2, int noiseFloor, bool stretch)
+    {
+        cv::Mat diff;
+
+        cv::Mat a = d1, b = d2;
+        if (b.size() != a.size()) cv::resize(b, b, a.size());
+
+        cv::Mat ga, gb;
+        if (a.channels() == 3) cv::cvtColor(a, ga, cv::COLOR_BGR2GRAY);
+        else ga = a;
+        if (b.channels() == 3) cv::cvtColor(b, gb, cv::COLOR_BGR2GRAY);
+        else gb = b;
+
+        if (f1 > 1.0 && f2 > 1.0) {
+            const double ratio = (f1 > f2) ? (f1 / f2) : (f2 / f1);
+            if (ratio > 1.15) {
+                const double sigma = std::min(6.0, 0.6 * std::sqrt(ratio - 1.0));
+                int k = static_cast<int>(std::ceil(sigma * 3.0)) | 1;
+                if (k < 3) k = 3;
+                if (k > 31) k = 31;
+                if (f1 > f2) cv::GaussianBlur(ga, ga, cv::Size(k, k), sigma);
+                else         cv::GaussianBlur(gb, gb, cv::Size(k, k), sigma);
+            }
+        }
 
-        if (m_pendingFrames.load() >= 2) {
+        cv::absdiff(ga, gb, diff);
 
-            continue;
+        /* Thresholding and stretching run at full depth; only the colour map
+           needs 8 bits. */
+        const double maxVal = pixelMax(diff.depth());
+        if (noiseFloor > 0) {
+            cv::threshold(diff, diff, noiseFloor * pixelScale(diff.depth()), maxVal, cv::THRESH_TOZERO);
+        }
+
+        if (stretch) {
+            cv::normalize(diff, diff, 0, maxVal, cv::NORM_MINMAX);
+        }
+
+        diff = toDisplay8(diff);
+        cv::applyColorMap(diff, diff, cv::COLORMAP_JET);
+
+        return diff;
+    }
+
+    /* Downscales to at most twice the target and converts to an owned
+       8-bit QImage, so views only have to upload it. */
+    QImage toViewImage(const cv::Mat& mat, const QSize& target)
+    {
+        if (mat.empty()) return QImage();
+
+        cv::Mat src = mat;
+        const int targetW = std::max(1, target.width());
+        const int targetH = std::max(1, target.height());
+        if (src.cols > targetW * 2 || src.rows > targetH * 2) {
+            double k = std::min(static_cast<double>(targetW) / src.cols,
+                                static_cast<double>(targetH) / src.rows);
+            if (k > 0.0 && k < 1.0) {
+                cv::Mat small;
+                cv::resize(src, small, cv::Size(), k, k, cv::INTER_AREA);
+                src = small;
+            }
+        }
+        src = toDisplay8(src);
+
+        if (src.channels() == 1) {
+            QImage img(src.data, src.cols, src.rows, static_cast<int>(src.step), QImage::Format_Grayscale8);
+            return img.copy();
+        }
+        if (src.channels() == 3) {
+            cv::Mat rgb;
+            cv::cvtColor(src, rgb, cv::COLOR_BGR2RGB);
+            QImage img(rgb.data, rgb.cols, rgb.rows, static_cast<int>(rgb.step), QImage::Format_RGB888);
+            return img.copy();
+        }
+        return QImage();
+    }
+
+    void drawTarget(cv::Mat& img, cv::Point pt, const cv::Scalar& color8, const std::string& label)
+    {
+        const cv::Scalar color = color8 * pixelScale(img.depth());
+        cv::circle(img, pt, 20, color, 2);
+        cv::line(img, cv::Point(pt.x - 10, pt.y), cv::Point(pt.x + 10, pt.y), color, 2);
+        cv::line(img, cv::Point(pt.x, pt.y - 10), cv::Point(pt.x, pt.y + 10), color, 2);
+        cv::putText(img, label, cv::Point(pt.x + 25, pt.y + 5), cv::FONT_HERSHEY_SIMPLEX, 0.6, color, 2);
+    }
+
+    /* Tile focus scores over the view, scaled to the sharpest tile so the
+       map shows where the frame is sharp rather than how sharp. Writes a
+       new 8-bit buffer; img may be shared. */
+    void overlayFocusMap(cv::Mat& img, const cv::Mat& map)
+    {
+        double maxScore = 0.0;
+        cv::minMaxLoc(map, nullptr, &maxScore);
+        if (maxScore <= 0.0) return;
+        cv::Mat heat, color, out;
+        map.convertTo(heat, CV_8U, 255.0 / maxScore);
+        cv::resize(heat, heat, img.size(), 0, 0, cv::INTER_NEAREST);
+        cv::applyColorMap(heat, color, cv::COLORMAP_JET);
+        cv::Mat base = toDisplay8(img);
+        if (base.channels() == 1) cv::cvtColor(base, base, cv::COLOR_GRAY2BGR);
+        cv::addWeighted(base, 0.65, color, 0.35, 0.0, out);
+        img = out;
+    }
+}
+
+ViewComposer::ViewComposer(QObject* parent) : QThread(parent) {
+    m_remaps.resize(2 * kMaxCameras);
+    m_shifts.resize(kMaxCameras);
+    start();
+}
+ViewComposer::~ViewComposer() {
+    {
+        std::lock_guard<std::mutex> lk(m_jobMutex);
+        m_stop = true;
+    }
+    m_jobCv.notify_all();
+    wait();
+}
+void ViewComposer::submit(ComposeJob job) {
+    {
+        std::lock_guard<std::mutex> lk(m_jobMutex);
+        if (m_hasJob) ++m_replaced;
+        m_job = std::move(job);
+        m_hasJob = true;
+    }
+    m_jobCv.notify_one();
+}
+bool ViewComposer::takeLatest(ComposedView& out) {
+    m_notifyPending = false;
+    if (!m_mailbox.fetch()) return false;
+    out = m_mailbox.readSlot();
+    return true;
+}
+void ViewComposer::run() {
+    ComposeJob job;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lk(m_jobMutex);
+            m_jobCv.wait(lk, [this]() { return m_stop || m_hasJob; });
+            if (m_stop) return;
+            job = std::move(m_job);
+            m_hasJob = false;
+        }
+        {
+            StageMeter::Scope busy(m_meter);
+            try {
+                m_mailbox.writeSlot() = compose(job);
+            }
+            catch (const cv::Exception& e) {
+                std::cerr << "[compose] " << e.what() << std::endl;
+                continue;
+            }
+            m_mailbox.publish();
+        }
+        if (!m_notifyPending.exchange(true)) emit composed();
+    }
+}
+cv::Mat ViewComposer::resample(int slot, const cv::Mat& src, const cv::Matx33d& H, const cv::Size& dstSize,
+                               const LensModel& lens, uint64_t lensGen) {
+    const bool undistort = lens.valid();
+    if (!undistort && H == cv::Matx33d::eye() && dstSize == src.size()) return src;
+    if (!undistort) lensGen = 0;
+    /* Tables are rebuilt only when the sliders, the calibration, the lens
+       model or the frame size change; otherwise a frame costs one remap. */
+    RemapCache& rc = m_remaps[slot];
+    if (rc.map1.empty() || rc.H != H || rc.srcSize != src.size() || rc.dstSize != dstSize || rc.lensGen != lensGen) {
+        cv::Mat undistX, undistY;
+        if (undistort) undistortMaps(lens, src.size(), undistX, undistY);
+        buildRemap(H, dstSize, undistX, undistY, rc.map1, rc.map2);
+        rc.H = H;
+        rc.srcSize = src.size();
+        rc.dstSize = dstSize;
+        rc.lensGen = lensGen;
+    }
+    cv::Mat out;
+    cv::remap(src, out, rc.map1, rc.map2, cv::INTER_LINEAR, cv::BORDER_CONSTANT);
+    return out;
+}
+bool ViewComposer::trackShift(int c, const cv::Mat& ref, const cv::Mat& cam, int every,
+                              cv::Point2d& shift, double& response) {
+    ShiftState& st = m_shifts[c];
+    if (st.size != ref.size()) {
+        st = ShiftState();
+        st.size = ref.size();
+    }
+    /* A confident shift is reused for every - 1 frames; without one every
+       frame is measured so the mode recovers as soon as it can. */
+    if (!st.valid || ++st.age >= std::max(1, every)) {
+        double r = 0.0;
+        const cv::Point2d p = phaseShift(ref, cam, st.window, r);
+        st.age = 0;
+        st.response = r;
+        if (r >= kMinPhaseResponse) {
+            /* Each measurement is applied as is; changes inside the dead
+               band are sub-pixel noise and would only shimmer the view. */
+            const cv::Point2d d = p - st.shift;
+            if (!st.valid || std::hypot(d.x, d.y) >= kShiftDeadBandPx) st.shift = p;
+            st.valid = true;
+        } else {
+            st.valid = false;
+        }
+    }
+    shift = st.shift;
+    response = st.response;
+    return st.valid;
+}
+ComposedView ViewComposer::compose(const ComposeJob& job) {
+    const ViewMeta& v = job.view;
+    const int n = static_cast<int>(job.frames.size());
+    const int cam = v.compareCam;
+
+    ComposedView out;
+    out.meta       = job.meta;
+    out.view       = v;
+    out.diffMode   = v.diffMode;
+    out.compareCam = cam;
+    out.showPeaks  = v.trackPeaks;
+    out.focus1     = job.focus.size() > 0 ? job.focus[0] : 0.0;
+    out.focus2     = static_cast<int>(job.focus.size()) > cam ? job.focus[cam] : 0.0;
+    if (n < 2 || cam < 1 || cam >= n) return out;
+
+    /* Frames are shared with the GUI and the snapshot path. Every stage
+       below writes to a new buffer, so nothing is copied up front; only the
+       in-place peak markers need ownCopy(). */
+    auto ownCopy = [&](cv::Mat& m) {
+        for (const cv::Mat& f : job.frames) {
+            if (m.datastart == f.datastart) {
+                m = m.clone();
+                return;
+            }
+        }
+    };
+    auto manualH = [&](int c) -> cv::Matx33d {
+        if (c >= static_cast<int>(v.manual.size()) || v.manual[c].isIdentity()) return cv::Matx33d::eye();
+        return buildManualHomography(v.manual[c], job.frames[c].size());
+    };
+
+    const LensModel noLens;
+    auto lensOf = [&](int c) -> const LensModel& {
+        return c < static_cast<int>(job.lenses.size()) ? job.lenses[c] : noLens;
+    };
+
+    const cv::Size refSize = job.frames[0].size();
+    cv::Mat f1 = resample(0, job.frames[0], manualH(0), refSize, lensOf(0), job.lensGen);
+
+    const bool wantShift = v.shiftAlign;
+    const bool wantAlign = wantShift || (v.alignEnabled && v.calibrated);
+    const bool wantFusion = v.fusion && (v.calibrated || wantShift);
+    if (!wantShift) {
+        for (ShiftState& st : m_shifts) st.valid = false;
+    }
+
+    /* Only the compared camera is needed unless fusion takes all of them.
+       Calibration maps the manually adjusted camera onto the adjusted
+       reference, so both transforms fold into one homography E * M and
+       each frame is resampled once. Slot 2c caches M, slot 2c + 1 E * M.
+       In shift mode the adjusted camera is resampled onto the reference
+       grid (S * M, S scaling its size to the reference), measured against
+       the adjusted reference there and moved by a plain translation in
+       reference pixels; a weak correlation peak falls back to E * M when
+       there is a calibration. */
+    std::vector<cv::Mat> adjusted(n), warped(n);
+    std::vector<cv::Point2d> shifts(n);
+    std::vector<double> responses(n, 0.0);
+    std::vector<char> shifted(n, 0);
+    for (int c = 1; c < n; ++c) {
+        if (c != cam && !wantFusion) continue;
+        const cv::Mat& f = job.frames[c];
+        const cv::Matx33d M = manualH(c);
+        const bool needWarped = wantFusion || (c == cam && wantAlign);
+        if (needWarped && wantShift) {
+            const cv::Matx33d S(static_cast<double>(refSize.width) / f.cols, 0, 0,
+                                0, static_cast<double>(refSize.height) / f.rows, 0,
+                                0, 0, 1);
+            adjusted[c] = resample(2 * c, f, S * M, refSize, lensOf(c), job.lensGen);
+            if (trackShift(c, f1, adjusted[c], v.shiftEvery, shifts[c], responses[c])) {
+                const cv::Matx23d T(1, 0, -shifts[c].x, 0, 1, -shifts[c].y);
+                cv::warpAffine(adjusted[c], warped[c], T, refSize, cv::INTER_LINEAR, cv::BORDER_CONSTANT);
+                shifted[c] = 1;
+            }
+        }
+        const bool hasEcc = needWarped && warped[c].empty() && v.calibrated
+                            && c < static_cast<int>(v.eccWarps.size()) && !v.eccWarps[c].empty();
+        if (hasEcc) {
+            try {
+                cv::Mat e;
+                v.eccWarps[c].convertTo(e, CV_64F);
+                warped[c] = resample(2 * c + 1, f, cv::Matx33d(e.ptr<double>()) * M, refSize, lensOf(c), job.lensGen);
+            }
+            catch (const cv::Exception& e) {
+                std::cerr << "Warp error: " << e.what() << std::endl;
+            }
+        }
+        if (adjusted[c].empty() && (warped[c].empty() || (c == cam && !wantAlign)))
+            adjusted[c] = resample(2 * c, f, M, f.size(), lensOf(c), job.lensGen);
+        if (warped[c].empty()) warped[c] = adjusted[c];
+    }
+    if (wantShift) {
+        out.view.shift         = shifts[cam];
+        out.view.shiftResponse = responses[cam];
+        out.view.shiftFallback = !shifted[cam];
+    }
+
+    cv::Mat alignedF2 = wantAlign ? warped[cam] : adjusted[cam];
+    if (wantFusion) {
+        f1 = fuseCameras(f1, std::vector<cv::Mat>(warped.begin() + 1, warped.end()));
+    }
+
+    cv::Point maxLoc1, maxLoc2;
+    if (out.showPeaks) {
+        cv::Mat g1, g2;
+        if (f1.channels() == 3) cv::cvtColor(f1, g1, cv::COLOR_BGR2GRAY);
+        else g1 = f1;
+
+        if (alignedF2.channels() == 3) cv::cvtColor(alignedF2, g2, cv::COLOR_BGR2GRAY);
+        else g2 = alignedF2;
+
+        cv::Mat blur1, blur2;
+        cv::blur(g1, blur1, cv::Size(31, 31));
+        cv::blur(g2, blur2, cv::Size(31, 31));
+
+        cv::minMaxLoc(blur1, nullptr, nullptr, nullptr, &maxLoc1);
+        cv::minMaxLoc(blur2, nullptr, nullptr, nullptr, &maxLoc2);
+
+        cv::minMaxLoc(g1, nullptr, &out.peak1, nullptr, nullptr);
+        cv::minMaxLoc(g2, nullptr, &out.peak2, nullptr, nullptr);
+    }
+
+    if (!out.diffMode) {
+        /* Maps are measured on the camera frames; the compared one is
+           drawn over the aligned frame, off by the alignment warp. */
+        if (v.focusMap && job.meta) {
+            const std::vector<CameraMeta>& cams = job.meta->cams;
+            if (!cams.empty() && !cams[0].focusMap.empty()) overlayFocusMap(f1, cams[0].focusMap);
+            if (cam < static_cast<int>(cams.size()) && !cams[cam].focusMap.empty())
+                overlayFocusMap(alignedF2, cams[cam].focusMap);
+        }
+        if (out.showPeaks) {
+            if (f1.channels() == 1) cv::cvtColor(f1, f1, cv::COLOR_GRAY2BGR);
+            if (alignedF2.channels() == 1) cv::cvtColor(alignedF2, alignedF2, cv::COLOR_GRAY2BGR);
+            ownCopy(f1);
+            ownCopy(alignedF2);
+            drawTarget(f1, maxLoc1, cv::Scalar(0, 255, 255), "Max 1");
+            drawTarget(alignedF2, maxLoc2, cv::Scalar(0, 255, 255), "Max " + std::to_string(cam + 1));
+        }
+        out.image1 = toViewImage(f1, job.view1Size);
+        out.image2 = toViewImage(alignedF2, job.view2Size);
+    } else {
+        cv::Mat diff = diffView(f1, alignedF2, out.focus1, out.focus2, job.noiseFloor, v.stretch);
+        if (out.showPeaks) {
+            drawTarget(diff, maxLoc1, cv::Scalar(0, 255, 255), "P1");
+            drawTarget(diff, maxLoc2, cv::Scalar(255, 0, 255), "P" + std::to_string(cam + 1));
         }
-        m_pendingFrames.fetch_add(1);
-        emit framesProcessed(f1.clone(), f2.clone(), focus1, focus2, motionDetected, m_frameCount);
+        out.diff = diff;
+        out.diffImage = toViewImage(diff, job.resultSize);
     }
+    return out;
 }
 
 namespace {
@@ -627,7 +1331,6 @@ static cv::Mat qImageToBGR(const QImage& src) {
     return bgr;
 }
 
-
 namespace T {
     static const char* bg0 = "#050505";
     static const char* bg1 = "#0e0e0e";
@@ -647,6 +1350,13 @@ namespace T {
     static const char* err = "#f07d72";
     static const char* cam1 = "#5dcaa5";
     static const char* cam2 = "#f0997b";
+    static const char* cam3 = "#8fb4ea";
+    static const char* cam4 = "#d6a2e8";
+
+    static const char* camColor(int cam) {
+        static const char* const colors[] = { cam1, cam2, cam3, cam4 };
+        return colors[std::clamp(cam, 0, 3)];
+    }
 }
 
 static void setPillState(QLabel* lbl, const char* state, const QString& text = QString())
@@ -667,6 +1377,37 @@ static QString settingsPath()
     return dir + "/dualcam.ini";
 }
 
+/* Calibrated matrices live apart from the settings, one group per
+   camera set and mode, named by a hash of the full key. */
+static QString alignCachePath()
+{
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
+    QDir().mkpath(dir);
+    return dir + "/alignment_cache.ini";
+}
+
+static QString alignCacheGroup(const QString& key)
+{
+    return QString::fromLatin1(QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex().left(16));
+}
+
+static QVariantList matToVariantList(const cv::Mat& m)
+{
+    QVariantList v;
+    cv::Mat d;
+    m.convertTo(d, CV_64F);
+    for (auto it = d.begin<double>(); it != d.end<double>(); ++it) v << *it;
+    return v;
+}
+
+static cv::Mat variantListToMat(const QVariantList& v, int rows)
+{
+    if (v.isEmpty() || rows <= 0 || v.size() % rows != 0) return cv::Mat();
+    cv::Mat m(rows, static_cast<int>(v.size()) / rows, CV_64F);
+    for (int i = 0; i < m.rows * m.cols; ++i) m.at<double>(i / m.cols, i % m.cols) = v[i].toDouble();
+    return m;
+}
+
 struct FilenameParamSpec {
     const char* key;
     const char* label;
@@ -696,10 +1437,31 @@ MainWindow::MainWindow(QWidget* parent)
     QApplication::setLayoutDirection(Qt::LeftToRight);
 
     m_worker = new CameraWorker(this);
-    connect(m_worker, &CameraWorker::framesProcessed, this, &MainWindow::onFramesProcessed, Qt::QueuedConnection);
+    connect(m_worker, &CameraWorker::framesReady, this, &MainWindow::onFramesProcessed, Qt::QueuedConnection);
+    m_composer = new ViewComposer(this);
+    connect(m_composer, &ViewComposer::composed, this, &MainWindow::onViewComposed, Qt::QueuedConnection);
     connect(m_worker, &CameraWorker::cameraError, this, [this](const QString& msg) {
         if (m_statusBar) m_statusBar->showMessage(msg, 5000);
     });
+    connect(m_worker, &CameraWorker::cameraStalled, this, [this](int cam, bool stalled) {
+        if (cam < 0 || cam >= kMaxCameras) return;
+        m_camStalled[cam] = stalled;
+        if (!m_camerasOpen || !m_fpsPill) return;
+        const auto stalledCam = std::find(m_camStalled.begin(), m_camStalled.end(), true);
+        if (stalledCam != m_camStalled.end()) {
+            setPillState(m_fpsPill, "warn", QString("CAM%1 RECONNECTING")
+                         .arg(static_cast<int>(stalledCam - m_camStalled.begin()) + 1));
+        } else {
+            updateFpsPill();
+        }
+    });
+
+    m_discovery = new CameraDiscovery(this);
+    connect(m_discovery, &CameraDiscovery::camerasChanged, this, [this]() {
+        if (!m_openWhenDiscovered) return;
+        m_openWhenDiscovered = false;
+        if (!m_camerasOpen) openCameras();
+    });
 
     for (const auto& spec : kFilenameParamSpecs) {
         m_paramInName[QString::fromLatin1(spec.key)] = true;
@@ -723,6 +1485,8 @@ MainWindow::~MainWindow()
     saveSettings();
     closeCameras();
     if (m_calibThread.joinable()) m_calibThread.join();
+    m_aligner.stop();
+    if (m_trackThread.joinable()) m_trackThread.join();
 }
 
 QString MainWindow::styleSheetText() const
@@ -1449,16 +2213,33 @@ QWidget* MainWindow::buildCaptureTab()
         m_colorMode = static_cast<ColorMode>(i);
         pushWorkerParams();
     });
-    grid->addWidget(m_comboColorMode, 1, 0);
-
-    grid->addWidget(sectionLabel("FLIP CAM2"), 0, 1);
+    QWidget* colorBox = new QWidget(this);
+    QHBoxLayout* colorLay = new QHBoxLayout(colorBox);
+    colorLay->setContentsMargins(0, 0, 0, 0);
+    colorLay->setSpacing(6);
+    m_chkHighBitDepth = new QCheckBox("16-bit", this);
+    m_chkHighBitDepth->setToolTip("Capture Y10/Y12/Y16 where the sensor offers it and keep 16 bits "
+                                  "through denoise, focus, diff and snapshots (applies on next start)");
+    colorLay->addWidget(m_comboColorMode, 1);
+    colorLay->addWidget(m_chkHighBitDepth);
+    grid->addWidget(colorBox, 1, 0);
+
+    m_lblFlipSection = sectionLabel("FLIP CAM2");
+    grid->addWidget(m_lblFlipSection, 0, 1);
     QWidget* flipBox = new QWidget(this);
     QHBoxLayout* flipLay = new QHBoxLayout(flipBox);
     flipLay->setContentsMargins(0, 0, 0, 0);
+    /* The checkboxes act on the camera currently compared to CAM1. */
     m_chkFlipHor2 = new QCheckBox("Horizontal", this);
     m_chkFlipVer2 = new QCheckBox("Vertical", this);
-    connect(m_chkFlipHor2, &QCheckBox::stateChanged, this, [this](int) { pushWorkerParams(); });
-    connect(m_chkFlipVer2, &QCheckBox::stateChanged, this, [this](int) { pushWorkerParams(); });
+    connect(m_chkFlipHor2, &QCheckBox::toggled, this, [this](bool on) {
+        m_flips[m_compareCam].hor = on;
+        pushWorkerParams();
+    });
+    connect(m_chkFlipVer2, &QCheckBox::toggled, this, [this](bool on) {
+        m_flips[m_compareCam].ver = on;
+        pushWorkerParams();
+    });
     flipLay->addWidget(m_chkFlipHor2);
     flipLay->addWidget(m_chkFlipVer2);
     flipLay->addStretch();
@@ -1488,6 +2269,90 @@ QWidget* MainWindow::buildCaptureTab()
     bfLay->addWidget(m_bilateralLabel);
     grid->addWidget(bfBox, 1, 2);
 
+    grid->addWidget(sectionLabel("PAIRING"), 2, 1);
+    QWidget* pairBox = new QWidget(this);
+    QHBoxLayout* pairLay = new QHBoxLayout(pairBox);
+    pairLay->setContentsMargins(0, 0, 0, 0);
+    pairLay->setSpacing(6);
+    m_comboPairing = new QComboBox(this);
+    m_comboPairing->addItems({ "Nearest", "Latest of each", "Drop on skew" });
+    m_comboPairing->setToolTip("How frames from the two capture threads are matched by timestamp");
+    m_spnMaxSkew = new QSpinBox(this);
+    m_spnMaxSkew->setRange(1, 100);
+    m_spnMaxSkew->setValue(8);
+    m_spnMaxSkew->setSuffix(" ms");
+    m_spnMaxSkew->setToolTip("Maximum inter-camera skew before a pair is dropped");
+    m_spnMaxSkew->setEnabled(false);
+    connect(m_comboPairing, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int i) {
+        m_spnMaxSkew->setEnabled(static_cast<PairingPolicy>(i) == PairingPolicy::DropOnSkew);
+        pushWorkerParams();
+    });
+    connect(m_spnMaxSkew, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int) { pushWorkerParams(); });
+    pairLay->addWidget(m_comboPairing, 1);
+    pairLay->addWidget(m_spnMaxSkew);
+    grid->addWidget(pairBox, 3, 1);
+
+    grid->addWidget(sectionLabel("SOURCE"), 2, 2);
+    QWidget* srcBox = new QWidget(this);
+    QHBoxLayout* srcLay = new QHBoxLayout(srcBox);
+    srcLay->setContentsMargins(0, 0, 0, 0);
+    srcLay->setSpacing(6);
+    m_comboSource = new QComboBox(this);
+    m_comboSource->addItems({ "Live cameras", "Recordings...", "Synthetic" });
+    m_comboSource->setToolTip("Offline sources replay without cameras (benchmarks, regression runs)");
+    m_spnReplayFps = new QSpinBox(this);
+    m_spnReplayFps->setRange(0, 240);
+    m_spnReplayFps->setSuffix(" fps");
+    m_spnReplayFps->setSpecialValueText("max");
+    m_spnReplayFps->setToolTip("Offline replay rate (max = as fast as the pipeline allows)");
+    m_spnReplayFps->setEnabled(false);
+    connect(m_comboSource, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int i) {
+        SourceKind kind = static_cast<SourceKind>(i);
+        if (kind == SourceKind::Files) {
+            QStringList files = QFileDialog::getOpenFileNames(this,
+                "Select one recording per camera (name order = CAM1, CAM2, ...)", QString(),
+                "Video / images (*.mp4 *.avi *.mkv *.mov *.png *.jpg *.tif *.tiff);;All files (*)");
+            if (files.size() < 2 || files.size() > kMaxCameras) {
+                if (!files.isEmpty())
+                    m_statusBar->showMessage(QString("Select 2 to %1 recordings, one per camera.").arg(kMaxCameras), 3000);
+                QSignalBlocker b(m_comboSource);
+                m_comboSource->setCurrentIndex(static_cast<int>(m_sourceSpec.kind));
+                return;
+            }
+            files.sort();
+            m_sourceSpec.paths.clear();
+            for (const QString& f : files) m_sourceSpec.paths.push_back(f.toStdString());
+            setCameraCount(files.size());
+        }
+        m_sourceSpec.kind = kind;
+        m_spnReplayFps->setEnabled(kind != SourceKind::Live);
+    });
+    srcLay->addWidget(m_comboSource, 1);
+    srcLay->addWidget(m_spnReplayFps);
+    grid->addWidget(srcBox, 3, 2);
+
+    grid->addWidget(sectionLabel("CAMERAS"), 4, 0);
+    QWidget* camsBox = new QWidget(this);
+    QHBoxLayout* camsLay = new QHBoxLayout(camsBox);
+    camsLay->setContentsMargins(0, 0, 0, 0);
+    camsLay->setSpacing(6);
+    m_spnCameraCount = new QSpinBox(this);
+    m_spnCameraCount->setRange(2, kMaxCameras);
+    m_spnCameraCount->setValue(m_cameraCount);
+    m_spnCameraCount->setToolTip("Number of synchronized cameras; CAM1 is the reference (applies on next start)");
+    connect(m_spnCameraCount, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int n) {
+        setCameraCount(n);
+    });
+    m_comboCompareCam = new QComboBox(this);
+    m_comboCompareCam->setToolTip("Camera shown next to CAM1 and used for diff, flips and peaks");
+    connect(m_comboCompareCam, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int i) {
+        if (i >= 0) setCompareCam(i + 1);
+    });
+    camsLay->addWidget(m_spnCameraCount);
+    camsLay->addWidget(new QLabel("vs", this));
+    camsLay->addWidget(m_comboCompareCam, 1);
+    grid->addWidget(camsBox, 5, 0);
+
     grid->addWidget(sectionLabel("VIEW"), 2, 0);
     m_chkStretchView = new QCheckBox("Adaptive view", this);
     m_chkStretchView->setToolTip("Scale images to fill the viewport (maintains aspect ratio, crops edges)");
@@ -1534,6 +2399,12 @@ QWidget* MainWindow::buildPipelineTab()
         m_bufferLabel->setText(QString::number(v));
         pushWorkerParams();
     });
+    m_comboTemporal = new QComboBox(this);
+    m_comboTemporal->addItems({ "EMA", "Median", "Trimmed" });
+    m_comboTemporal->setToolTip("EMA averages over the buffer length; Median and Trimmed keep the last frames "
+                                "(up to 16) in a ring and reject hot pixels and spikes");
+    connect(m_comboTemporal, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int) { pushWorkerParams(); });
+    bufLay->addWidget(m_comboTemporal);
     bufLay->addWidget(m_bufferSlider, 1);
     bufLay->addWidget(m_bufferLabel);
     row1->addWidget(bufBox, 1, 0);
@@ -1553,6 +2424,12 @@ QWidget* MainWindow::buildPipelineTab()
         m_motionThresholdLabel->setText(QString("%1%").arg(v));
         pushWorkerParams();
     });
+    m_comboMotionModel = new QComboBox(this);
+    m_comboMotionModel->addItems({ "Diff", "MOG2" });
+    m_comboMotionModel->setToolTip("Motion model on a 1/4 or 1/8 scale gray level of every camera: running-average "
+                                   "frame difference (cheap) or MOG2 (copes with repetitive background motion)");
+    connect(m_comboMotionModel, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int) { pushWorkerParams(); });
+    motLay->addWidget(m_comboMotionModel);
     motLay->addWidget(m_motionThresholdSlider, 1);
     motLay->addWidget(m_motionThresholdLabel);
     row1->addWidget(motBox, 1, 1);
@@ -1561,7 +2438,7 @@ QWidget* MainWindow::buildPipelineTab()
     QWidget* fuseBox = new QWidget(this);
     QHBoxLayout* fuseLay = new QHBoxLayout(fuseBox);
     fuseLay->setContentsMargins(0, 0, 0, 0);
-    m_chkFusion = new QCheckBox("Blend CAM1+CAM2", this);
+    m_chkFusion = new QCheckBox("Blend all cameras", this);
     m_motionIndicator = new QLabel(QString::fromUtf8("\u25CF Idle"), this);
     m_motionIndicator->setStyleSheet(QString("color:%1; font-weight:600;").arg(T::textDim));
     fuseLay->addWidget(m_chkFusion);
@@ -1596,7 +2473,7 @@ QWidget* MainWindow::buildPipelineTab()
     m_btnCalibrateAlign->setMinimumHeight(28);
     connect(m_btnCalibrateAlign, &QPushButton::clicked, this, &MainWindow::calibrateAlignment);
 
-    m_chkAlign = new QCheckBox("Apply to CAM2", this);
+    m_chkAlign = new QCheckBox("Warp onto CAM1", this);
     m_chkAlign->setMinimumHeight(28);
     connect(m_chkAlign, &QCheckBox::stateChanged, this, &MainWindow::updateView);
 
@@ -1614,20 +2491,98 @@ QWidget* MainWindow::buildPipelineTab()
         }
     });
 
+    m_chkTrackAlign = new QCheckBox("Track drift", this);
+    m_chkTrackAlign->setMinimumHeight(28);
+    connect(m_chkTrackAlign, &QCheckBox::toggled, this, [this]() { updateEccPill(); });
+
     eccButtons->addWidget(m_btnCalibrateAlign, 1);
     eccButtons->addWidget(m_chkAlign, 1);
+    eccButtons->addWidget(m_chkTrackAlign, 1);
     eccButtons->addWidget(m_btnOpenManualAlign, 1);
     eccLay->addLayout(eccButtons);
 
+    QHBoxLayout* shiftRow = new QHBoxLayout();
+    shiftRow->setSpacing(6);
+    m_chkShiftAlign = new QCheckBox("Shift only (phase correlation)", this);
+    m_chkShiftAlign->setMinimumHeight(28);
+    m_chkShiftAlign->setToolTip("Track translation on every frame; falls back to the calibrated warp when the correlation peak is weak");
+    m_spnShiftEvery = new QSpinBox(this);
+    m_spnShiftEvery->setRange(1, 30);
+    m_spnShiftEvery->setValue(1);
+    m_spnShiftEvery->setPrefix("every ");
+    m_spnShiftEvery->setSuffix(" fr");
+    m_spnShiftEvery->setToolTip("Measure the shift every N frames and reuse it in between");
+    m_spnShiftEvery->setEnabled(false);
+    connect(m_chkShiftAlign, &QCheckBox::toggled, this, [this](bool on) {
+        m_spnShiftEvery->setEnabled(on);
+        m_phaseFallback = true;
+        m_phaseResponse = 0.0;
+        updateEccPill();
+        updateView();
+    });
+    connect(m_spnShiftEvery, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int) { updateView(); });
+    shiftRow->addWidget(m_chkShiftAlign, 1);
+    shiftRow->addWidget(m_spnShiftEvery);
+    eccLay->addLayout(shiftRow);
+
     QLabel* eccHint = new QLabel(
-        "Calibrate solves the warp matrix once (SIFT + FLANN + RANSAC). "
-        "Apply reuses that matrix on every frame.",
+        "Calibrate solves the warp matrix once (SIFT and ORB raced on a coarse level, refined at full resolution). "
+        "Apply reuses that matrix on every frame. Track drift refines it in the "
+        "background (pyramid ECC) and eases the corrections in. Shift only follows translation with "
+        "phase correlation on downscaled frames and uses the calibrated warp while the peak is weak.",
         this);
     eccHint->setWordWrap(true);
     eccHint->setProperty("role", "faint");
     eccLay->addWidget(eccHint);
 
     root->addWidget(eccCard);
+
+    QFrame* lensCard = new QFrame(this);
+    lensCard->setProperty("role", "card");
+    QVBoxLayout* lensLay = new QVBoxLayout(lensCard);
+    lensLay->setContentsMargins(12, 10, 12, 12);
+    lensLay->setSpacing(10);
+
+    QHBoxLayout* lensHeader = new QHBoxLayout();
+    QLabel* lensTitle = new QLabel("LENS", this);
+    lensTitle->setProperty("role", "section");
+    m_lensIndicator = new QLabel("NO LENS MODEL", this);
+    setPillState(m_lensIndicator, "err");
+    lensHeader->addWidget(lensTitle);
+    lensHeader->addWidget(m_lensIndicator);
+    lensHeader->addStretch();
+    lensLay->addLayout(lensHeader);
+
+    QHBoxLayout* lensButtons = new QHBoxLayout();
+    lensButtons->setSpacing(6);
+    m_btnLensCapture = new QPushButton("Capture target", this);
+    m_btnLensCapture->setMinimumHeight(28);
+    connect(m_btnLensCapture, &QPushButton::clicked, this, &MainWindow::captureLensTarget);
+
+    m_chkUndistort = new QCheckBox("Undistort", this);
+    m_chkUndistort->setMinimumHeight(28);
+    connect(m_chkUndistort, &QCheckBox::toggled, this, &MainWindow::undistortChanged);
+
+    m_btnLensReset = new QPushButton("Reset", this);
+    m_btnLensReset->setMinimumHeight(28);
+    connect(m_btnLensReset, &QPushButton::clicked, this, &MainWindow::resetLensCalibration);
+
+    lensButtons->addWidget(m_btnLensCapture, 1);
+    lensButtons->addWidget(m_chkUndistort, 1);
+    lensButtons->addWidget(m_btnLensReset, 1);
+    lensLay->addLayout(lensButtons);
+
+    QLabel* lensHint = new QLabel(
+        QString("Show a %1x%2 inner-corner chessboard to the cameras and capture it "
+                "from %3 different poses; each camera gets its own intrinsics and "
+                "distortion. Undistortion rides on the alignment remap at no extra cost.")
+            .arg(kLensBoardCols).arg(kLensBoardRows).arg(kLensViewsNeeded),
+        this);
+    lensHint->setWordWrap(true);
+    lensHint->setProperty("role", "faint");
+    lensLay->addWidget(lensHint);
+
+    root->addWidget(lensCard);
     root->addStretch();
     return page;
 }
@@ -1698,15 +2653,13 @@ void MainWindow::buildFocusChart()
     m_chartView->setMinimumHeight(160);
     m_chartView->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
 
-    m_seriesCam1 = new QLineSeries();
-    m_seriesCam1->setName("Camera 1 Focus");
-    m_seriesCam1->setColor(QColor(T::cam1));
-    m_seriesCam2 = new QLineSeries();
-    m_seriesCam2->setName("Camera 2 Focus");
-    m_seriesCam2->setColor(QColor(T::cam2));
-
-    m_chart->addSeries(m_seriesCam1);
-    m_chart->addSeries(m_seriesCam2);
+    for (int c = 0; c < kMaxCameras; ++c) {
+        QLineSeries* s = new QLineSeries();
+        s->setName(QString("Camera %1 Focus").arg(c + 1));
+        s->setColor(QColor(T::camColor(c)));
+        m_chart->addSeries(s);
+        m_seriesCam << s;
+    }
 
     QValueAxis* axisX = new QValueAxis;
     axisX->setTitleText("Time (Frames)");
@@ -1726,16 +2679,21 @@ void MainWindow::buildFocusChart()
     axisY->setGridLineColor(QColor(T::border));
     m_chart->addAxis(axisY, Qt::AlignLeft);
 
-    m_seriesCam1->attachAxis(axisX);
-    m_seriesCam1->attachAxis(axisY);
-    m_seriesCam2->attachAxis(axisX);
-    m_seriesCam2->attachAxis(axisY);
+    for (QLineSeries* s : m_seriesCam) {
+        s->attachAxis(axisX);
+        s->attachAxis(axisY);
+    }
 
     m_chart->legend()->setVisible(true);
     m_chart->legend()->setAlignment(Qt::AlignTop);
     m_chart->legend()->setLabelColor(QColor(T::text));
 }
 
+namespace {
+    /* Tiles of the focus map, close to the 4:3 of the sensors. */
+    const cv::Size kFocusGrid(8, 6);
+}
+
 QWidget* MainWindow::buildFocusDataPanel()
 {
     QWidget* panel = new QWidget(this);
@@ -1753,7 +2711,7 @@ QWidget* MainWindow::buildFocusDataPanel()
     lay->setContentsMargins(14, 10, 14, 10);
     lay->setSpacing(8);
 
-    auto makeCard = [this](const QString& title, const char* titleColor, QLabel*& valueLabel) {
+    auto makeCard = [this](const QString& title, const char* titleColor, QLabel*& valueLabel, QLabel*& detailLabel) {
         QFrame* card = new QFrame(this);
         card->setProperty("role", "card");
         QVBoxLayout* cardLay = new QVBoxLayout(card);
@@ -1765,13 +2723,17 @@ QWidget* MainWindow::buildFocusDataPanel()
             "color:%1; font-size:10px; font-weight:600; letter-spacing:0.10em;").arg(titleColor));
         valueLabel = new QLabel("0", card);
         valueLabel->setProperty("role", "hero");
+        detailLabel = new QLabel("TEN 0  BREN 0", card);
+        detailLabel->setProperty("role", "mono");
+        detailLabel->setToolTip("Tenengrad: mean Sobel gradient energy. Brenner: mean squared difference of pixels two apart.");
         cardLay->addWidget(t);
         cardLay->addWidget(valueLabel);
+        cardLay->addWidget(detailLabel);
         return card;
     };
 
-    lay->addWidget(makeCard("CAM1 FOCUS", T::cam1, m_lblFocus1Big), 1);
-    lay->addWidget(makeCard("CAM2 FOCUS", T::cam2, m_lblFocus2Big), 1);
+    lay->addWidget(makeCard("CAM1 FOCUS", T::cam1, m_lblFocus1Big, m_lblFocus1Detail), 1);
+    lay->addWidget(makeCard("COMPARED FOCUS", T::cam2, m_lblFocus2Big, m_lblFocus2Detail), 1);
 
     QFrame* histCard = new QFrame(this);
     histCard->setProperty("role", "card");
@@ -1817,6 +2779,12 @@ QWidget* MainWindow::buildFocusDataPanel()
     histControls->addWidget(m_historySpinBox);
     histLay->addLayout(histControls);
 
+    m_chkFocusMap = new QCheckBox("Focus map overlay", this);
+    m_chkFocusMap->setToolTip(QString("Laplacian variance per tile on a %1 x %2 grid, drawn over both views")
+                                  .arg(kFocusGrid.width).arg(kFocusGrid.height));
+    connect(m_chkFocusMap, &QCheckBox::toggled, this, [this](bool) { pushWorkerParams(); });
+    histLay->addWidget(m_chkFocusMap);
+
     lay->addWidget(histCard, 1);
     rootLay->addWidget(cardsWidget, 0);
     return panel;
@@ -2515,7 +3483,7 @@ void MainWindow::recreateGpuViews()
         return v;
     };
     m_view1     = makeFresh("CAM 1");
-    m_view2     = makeFresh("CAM 2");
+    m_view2     = makeFresh(QString("CAM %1").arg(m_compareCam + 1));
     m_resultView = makeFresh("RESULT");
 
     m_splitter->insertWidget(0, m_view1);
@@ -2532,17 +3500,14 @@ void MainWindow::recreateGpuViews()
     if (oldView2)  oldView2->deleteLater();
     if (oldResult) oldResult->deleteLater();
 
-    if (m_isDiffMode && !m_lastDiffResult.empty()) {
+    /* Recompose on ViewComposer for the new view sizes; the last diff is
+       only reused while no frames are streaming. */
+    if (m_camerasOpen && static_cast<int>(m_frames.size()) > m_compareCam) {
+        updateView();
+    } else if (m_isDiffMode && !m_lastDiffResult.empty()) {
         m_resultView->setOverlayColor(QColor(0xff, 0xff, 0xff));
         m_resultView->setOverlayText("DIFF", false);
         displayMat(m_resultView, m_lastDiffResult);
-    } else if (!m_frame1.empty() && !m_frame2.empty()) {
-        m_view1->setOverlayColor(QColor(0x4e, 0xc9, 0xb0));
-        m_view1->setOverlayText(QString("CAM1  Focus %1").arg(static_cast<int>(m_lastFocus1)), false);
-        m_view2->setOverlayColor(QColor(0xce, 0x91, 0x78));
-        m_view2->setOverlayText(QString("CAM2  Focus %1").arg(static_cast<int>(m_lastFocus2)), true);
-        displayMat(m_view1, m_frame1);
-        displayMat(m_view2, m_frame2);
     }
 }
 
@@ -2604,6 +3569,10 @@ void MainWindow::launchProfileViewer(const cv::Mat& img, QPoint a, QPoint b,
         int y0 = int(std::floor(y)), y1 = std::min(y0 + 1, m.rows - 1);
         double fx = x - x0, fy = y - y0;
         auto px = [&](int xx, int yy) -> double {
+            if (m.depth() == CV_16U) {
+                if (m.channels() == 1) return m.at<ushort>(yy, xx);
+                return m.at<cv::Vec3w>(yy, xx)[channel];
+            }
             if (m.channels() == 1) return m.at<uchar>(yy, xx);
             return m.at<cv::Vec3b>(yy, xx)[channel];
         };
@@ -2637,6 +3606,7 @@ void MainWindow::launchProfileViewer(const cv::Mat& img, QPoint a, QPoint b,
     obj["bx"]      = b.x();
     obj["by"]      = b.y();
     obj["length"]  = length;
+    obj["maxValue"] = pixelMax(img.depth());
     obj["samples"] = samples;
 
 #ifndef DUALCAM_SEPARATE_VIEWER
@@ -2680,10 +3650,23 @@ void MainWindow::launchSurfaceViewer(const cv::Mat& img, QRect roi,
 
     const int cols = g.cols;
     const int rows = g.rows;
+    const bool wide = g.depth() == CV_16U;
     QByteArray gridBytes;
-    gridBytes.resize(cols * rows);
-    for (int y = 0; y < rows; ++y) {
-        std::memcpy(gridBytes.data() + y * cols, g.ptr<uchar>(y), cols);
+    if (wide) {
+        gridBytes.resize(cols * rows * 2);
+        uchar* dst = reinterpret_cast<uchar*>(gridBytes.data());
+        for (int y = 0; y < rows; ++y) {
+            const ushort* src = g.ptr<ushort>(y);
+            for (int x = 0; x < cols; ++x, dst += 2) {
+                dst[0] = static_cast<uchar>(src[x] & 0xff);
+                dst[1] = static_cast<uchar>(src[x] >> 8);
+            }
+        }
+    } else {
+        gridBytes.resize(cols * rows);
+        for (int y = 0; y < rows; ++y) {
+            std::memcpy(gridBytes.data() + y * cols, g.ptr<uchar>(y), cols);
+        }
     }
 
     const double kBackX = (cols > 0) ? (double(r.width)  / double(cols)) : 1.0;
@@ -2698,6 +3681,7 @@ void MainWindow::launchSurfaceViewer(const cv::Mat& img, QRect roi,
     obj["ky"]    = kBackY;
     obj["cols"]  = cols;
     obj["rows"]  = rows;
+    obj["bits"]  = pixelBits(g.depth());
     obj["grid"]  = QString::fromLatin1(gridBytes.toBase64());
 
 #ifndef DUALCAM_SEPARATE_VIEWER
@@ -2732,11 +3716,10 @@ void MainWindow::restoreMainViewAfterChildClose()
         this->raise();
 
         QTimer::singleShot(50, this, [this]() {
-            if (m_isDiffMode && !m_lastDiffResult.empty()) {
+            if (m_camerasOpen && static_cast<int>(m_frames.size()) > m_compareCam) {
+                updateView();
+            } else if (m_isDiffMode && !m_lastDiffResult.empty()) {
                 displayMat(m_resultView, m_lastDiffResult);
-            } else if (!m_frame1.empty() && !m_frame2.empty()) {
-                displayMat(m_view1, m_frame1);
-                displayMat(m_view2, m_frame2);
             }
         });
     });
@@ -2823,11 +3806,12 @@ void MainWindow::openPreviewWindow(const QString& imagePath, const QString& file
     AnalysisCanvas* canvas = new AnalysisCanvas(dlg);
     if (!raw.empty()) {
         cv::Mat disp;
-        if (raw.channels() == 1) {
-            QImage qimg(raw.data, raw.cols, raw.rows, static_cast<int>(raw.step), QImage::Format_Grayscale8);
+        const cv::Mat raw8 = toDisplay8(raw);
+        if (raw8.channels() == 1) {
+            QImage qimg(raw8.data, raw8.cols, raw8.rows, static_cast<int>(raw8.step), QImage::Format_Grayscale8);
             canvas->setImage(qimg.copy());
         } else {
-            cv::cvtColor(raw, disp, cv::COLOR_BGR2RGB);
+            cv::cvtColor(raw8, disp, cv::COLOR_BGR2RGB);
             QImage qimg(disp.data, disp.cols, disp.rows, static_cast<int>(disp.step), QImage::Format_RGB888);
             canvas->setImage(qimg.copy());
         }
@@ -2888,6 +3872,10 @@ void MainWindow::openPreviewWindow(const QString& imagePath, const QString& file
                          reinterpret_cast<const uint8_t*>(ba.constData()) + ba.size());
     }
     std::string desc = readExifDescription(jpegBytes);
+    if (desc.empty()) {
+        /* 16-bit snapshots are PNG with the description in a text chunk. */
+        desc = QImageReader(imagePath).text("Description").toStdString();
+    }
     QJsonDocument jdoc = desc.empty()
         ? QJsonDocument()
         : QJsonDocument::fromJson(QByteArray::fromStdString(desc));
@@ -3012,7 +4000,6 @@ void MainWindow::buildAlignDialog()
     m_alignDialog->setModal(false);
     m_alignDialog->resize(620, 460);
 
-
     m_alignDialog->setStyleSheet(styleSheetText() + QString(R"(
         QDialog QLabel { font-size: 12px; font-weight: 600; }
         QDialog QComboBox { font-size: 12px; padding: 4px 10px; min-height: 24px; }
@@ -3026,7 +4013,7 @@ void MainWindow::buildAlignDialog()
 
     QHBoxLayout* headerRow = new QHBoxLayout();
     m_comboAdjCam = new QComboBox(m_alignDialog);
-    m_comboAdjCam->addItems({ "CAM 1", "CAM 2" });
+    for (int c = 0; c < m_cameraCount; ++c) m_comboAdjCam->addItem(QString("CAM %1").arg(c + 1));
     m_comboAdjCam->setCurrentIndex(m_activeAdjCam - 1);
     connect(m_comboAdjCam, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int i) {
         m_activeAdjCam = i + 1;
@@ -3300,9 +4287,25 @@ void MainWindow::refreshSnapshotPreview()
 void MainWindow::updateEccPill()
 {
     if (!m_eccPill) return;
-    if (m_isAligned && !m_eccWarpMatrix.empty()) {
+    if (m_chkShiftAlign && m_chkShiftAlign->isChecked()) {
+        const QString peak = QString::number(m_phaseResponse, 'f', 2);
+        if (!m_phaseFallback) {
+            setPillState(m_eccPill, "ok", QString("SHIFT %1, %2 px  PEAK %3")
+                         .arg(m_phaseShift.x, 0, 'f', 1).arg(m_phaseShift.y, 0, 'f', 1).arg(peak));
+        } else if (m_isAligned) {
+            setPillState(m_eccPill, "warn", QString("SHIFT PEAK %1  \u2192 WARP").arg(peak));
+        } else {
+            setPillState(m_eccPill, "err", QString("SHIFT PEAK %1").arg(peak));
+        }
+        return;
+    }
+    if (m_isAligned) {
         if (m_chkAlign && m_chkAlign->isChecked()) {
-            setPillState(m_eccPill, "ok", "ALIGN ON");
+            if (m_chkTrackAlign && m_chkTrackAlign->isChecked()) {
+                setPillState(m_eccPill, "ok", QString("ALIGN ON  DRIFT %1 px").arg(m_alignDrift, 0, 'f', 1));
+            } else {
+                setPillState(m_eccPill, "ok", "ALIGN ON");
+            }
         } else {
             setPillState(m_eccPill, "info", "ALIGN READY");
         }
@@ -3335,49 +4338,50 @@ void MainWindow::refreshCameraModes()
     m_comboCamSet->addItem("Custom...", QVariantList{0, 0, 0});
 }
 
-QStringList MainWindow::getLibCameraIds()
+ExposureSettings MainWindow::exposureFor(int camIndex) const
 {
-    QStringList cameraPaths;
-    QProcess process;
+    ExposureSettings e;
+    e.manual    = m_manualExposure;
+    /* Per-camera mode has a reference set and one set shared by all other
+       cameras. */
+    const bool secondary = m_perCameraExposure && camIndex >= 1;
+    e.gain      = std::max(1.0, (secondary ? m_gain2Q8 : m_gainQ8) / 256.0);
+    e.shutterUs = secondary ? m_shutter2Us : m_shutterUs;
+    return e;
+}
 
-    QString program = "rpicam-hello";
-    process.start(program, QStringList() << "--list-cameras");
-    if (!process.waitForFinished() || process.exitCode() != 0) {
-        program = "libcamera-hello";
-        process.start(program, QStringList() << "--list-cameras");
-        process.waitForFinished();
-    }
-
-    QString output = process.readAllStandardOutput();
-
-    QRegularExpression re("\\((/base/[^)]+)\\)");
-    QRegularExpressionMatchIterator i = re.globalMatch(output);
-
-    while (i.hasNext()) {
-        QRegularExpressionMatch match = i.next();
-        if (match.hasMatch()) {
-            cameraPaths << match.captured(1);
-        }
-    }
-
-    return cameraPaths;
+std::vector<ExposureSettings> MainWindow::exposures() const
+{
+    std::vector<ExposureSettings> e;
+    for (int c = 0; c < m_cameraCount; ++c) e.push_back(exposureFor(c));
+    return e;
 }
 
-std::string MainWindow::makeGStreamerPipeline(const QString& cameraId, int width, int height, int fps, int camIndex)
+std::string MainWindow::makeGStreamerPipeline(const QString& cameraId, int width, int height, int fps, int camIndex, bool native)
 {
     QString controls;
-    if (m_manualExposure) {
-        int gainQ8     = (m_perCameraExposure && camIndex == 1) ? m_gain2Q8    : m_gainQ8;
-        int shutterUs  = (m_perCameraExposure && camIndex == 1) ? m_shutter2Us : m_shutterUs;
-        double gain = gainQ8 / 256.0;
-        if (gain < 1.0) gain = 1.0;
+    const ExposureSettings e = exposureFor(camIndex);
+    if (e.manual) {
         controls = QString(" ae-enable=false analogue-gain-mode=manual exposure-time-mode=manual analogue-gain=%1 exposure-time=%2")
-            .arg(gain, 0, 'f', 3)
-            .arg(shutterUs);
+            .arg(e.gain, 0, 'f', 3)
+            .arg(e.shutterUs);
     } else {
         controls = " ae-enable=true";
     }
 
+    if (native) {
+        /* Named so exposure can be pushed into the running element. */
+        return QString("libcamerasrc name=src camera-name=%1%5 ! "
+            "video/x-raw, width=%2, height=%3, framerate=%4/1, format=NV12 ! "
+            "appsink name=sink drop=true max-buffers=1 sync=false")
+            .arg(cameraId)
+            .arg(width)
+            .arg(height)
+            .arg(fps)
+            .arg(controls)
+            .toStdString();
+    }
+
     return QString("libcamerasrc camera-name=%1%5 ! "
         "video/x-raw, width=%2, height=%3, framerate=%4/1, format=NV12 ! "
         "videoconvert ! "
@@ -3393,19 +4397,23 @@ std::string MainWindow::makeGStreamerPipeline(const QString& cameraId, int width
 
 void MainWindow::applyExposureControls()
 {
+    if (!m_camerasOpen) return;
 
-    if (m_camerasOpen) {
-        m_statusBar->showMessage("Restarting cameras to apply exposure...", 2000);
-        closeCameras();
-        openCameras();
+    const uint32_t gen = m_worker->applyExposure(exposures());
+    if (gen != 0) {
+        m_pendingExposureGen = gen;
+        return;
     }
+
+    /* Backend cannot change exposure while streaming. */
+    m_pendingExposureGen = 0;
+    m_statusBar->showMessage("Restarting cameras to apply exposure...", 2000);
+    closeCameras();
+    openCameras();
 }
 
 void MainWindow::openCameras()
 {
-    m_statusBar->showMessage("Detecting cameras...");
-    QApplication::processEvents();
-
     int reqW = 640, reqH = 480, reqFps = 30;
     if (m_comboCamSet->count() > 0) {
         QVariantList v = m_comboCamSet->currentData().toList();
@@ -3416,39 +4424,67 @@ void MainWindow::openCameras()
         }
     }
 
-    QStringList camPaths = getLibCameraIds();
-    if (camPaths.size() < 2) {
-        m_statusBar->showMessage("Warning: < 2 libcameras found. Attempting fallback.", 3000);
-        int c1 = -1, c2 = -1;
-        for (int i = 0; i < 10; ++i) {
-            cv::VideoCapture tmp;
-#ifdef Q_OS_LINUX
-            tmp.open(i, cv::CAP_V4L2);
-#else
-            tmp.open(i, cv::CAP_DSHOW);
-#endif
-            if (tmp.isOpened()) {
-                if (c1 == -1) c1 = i;
-                else if (c2 == -1) { c2 = i; break; }
-            }
+    QStringList camIds;
+    if (m_sourceSpec.kind != SourceKind::Live) {
+        if (!startOfflineSources(reqW, reqH)) return;
+        for (int c = 0; c < m_cameraCount; ++c) {
+            camIds << (m_sourceSpec.kind == SourceKind::Synthetic
+                       ? QString("synthetic:%1").arg(c)
+                       : QFileInfo(QString::fromStdString(m_sourceSpec.paths[c])).absoluteFilePath());
         }
-        if (c1 != -1 && c2 != -1) {
-            m_worker->startCamerasV4L2(c1, c2, reqW, reqH, reqFps);
-        } else {
-            m_statusBar->showMessage("Error: Could not find two fallback cameras.", 3000);
+    } else {
+        m_worker->resetExposure(exposures());
+        if (!m_discovery->ready()) {
+            /* First scan still running; openCameras() is re-entered from camerasChanged. */
+            m_openWhenDiscovered = true;
+            m_statusBar->showMessage("Detecting cameras...");
             return;
         }
-    } else {
-        std::string p1 = makeGStreamerPipeline(camPaths[0], reqW, reqH, reqFps, 0);
-        std::string p2 = makeGStreamerPipeline(camPaths[1], reqW, reqH, reqFps, 1);
-        m_worker->startCameras(p1, p2, reqW, reqH, reqFps);
+        const int n = m_cameraCount;
+        const QStringList camPaths = m_discovery->libcameraIds();
+        if (camPaths.size() < n) {
+            const QList<int> devices = m_discovery->deviceIndices();
+            if (devices.size() < n) {
+                m_statusBar->showMessage(QString("Error: Could not find %1 fallback cameras.").arg(n), 3000);
+                m_discovery->refresh();
+                return;
+            }
+            m_statusBar->showMessage(QString("Warning: < %1 libcameras found. Attempting fallback.").arg(n), 3000);
+            m_worker->startCamerasV4L2(devices.mid(0, n), reqW, reqH, reqFps,
+                                       m_chkHighBitDepth && m_chkHighBitDepth->isChecked());
+            for (int c = 0; c < n; ++c) camIds << m_discovery->stableId(devices[c]);
+        } else {
+            auto pipelines = [&](bool native) {
+                std::vector<std::string> pipes;
+                for (int c = 0; c < n; ++c)
+                    pipes.push_back(makeGStreamerPipeline(camPaths[c], reqW, reqH, reqFps, c, native));
+                return pipes;
+            };
+            bool native = false;
+            if (GstAppSinkCapture::available()) {
+                native = m_worker->startCamerasNative(pipelines(true), reqFps);
+            }
+            if (!native) {
+                m_worker->startCameras(pipelines(false), reqFps);
+            }
+            camIds = camPaths.mid(0, n);
+        }
     }
 
     m_camerasOpen = true;
     m_isAligned = false;
-    m_eccWarpMatrix.release();
+    m_eccWarps.clear();
+    m_alignBaseline.clear();
+    m_alignTarget.clear();
+    ++m_alignGen;
+    m_validateAlign = false;
+    m_sessionCamIds = camIds;
+    m_sessionSize = QSize(reqW, reqH);
 
     if (m_comboCamSet) m_comboCamSet->setEnabled(false);
+    if (m_spnCameraCount) m_spnCameraCount->setEnabled(false);
+    if (m_comboSource) m_comboSource->setEnabled(false);
+    if (m_chkHighBitDepth) m_chkHighBitDepth->setEnabled(false);
 
     m_btnFabStream->setToolTip("Stop streaming");
     m_btnFabStream->setStyleSheet(QString(
@@ -3467,10 +4503,10 @@ void MainWindow::openCameras()
     updateFpsPill();
 
     m_motionActive = false;
+    m_camStalled.fill(false);
 
     m_frameCount = 0;
-    m_seriesCam1->clear();
-    m_seriesCam2->clear();
+    for (QLineSeries* s : m_seriesCam) s->clear();
 
     m_chart->axes(Qt::Horizontal).first()->setRange(0, m_maxHistory);
 
@@ -3481,6 +4517,108 @@ void MainWindow::openCameras()
     m_btnFabStream->style()->polish(m_btnFabStream);
 
     m_statusBar->showMessage("Cameras OK. Noise suppression active.", 4000);
+    loadCachedAlignment();
+}
+
+bool MainWindow::startOfflineSources(int width, int height)
+{
+    if (m_spnReplayFps) m_sourceSpec.rateFps = m_spnReplayFps->value();
+
+    std::vector<std::unique_ptr<FrameSource>> sources;
+    if (m_sourceSpec.kind == SourceKind::Synthetic) {
+        SyntheticParams sp = m_sourceSpec.synth;
+        sp.width  = width;
+        sp.height = height;
+        if (m_chkHighBitDepth && m_chkHighBitDepth->isChecked()) sp.bitDepth = 16;
+        for (int c = 0; c < m_cameraCount; ++c)
+            sources.push_back(makeSyntheticSource(c, sp, m_sourceSpec.rateFps));
+    } else {
+        setCameraCount(static_cast<int>(m_sourceSpec.paths.size()));
+        for (const std::string& path : m_sourceSpec.paths)
+            sources.push_back(makeFileSource(path, m_sourceSpec.rateFps, m_sourceSpec.loop));
+    }
+    const bool allOpen = sources.size() >= 2 &&
+        std::all_of(sources.begin(), sources.end(), [](const auto& s) { return s != nullptr; });
+    if (!allOpen) {
+        m_statusBar->showMessage("Error: Could not open offline frame sources.", 3000);
+        return false;
+    }
+    m_worker->startSources(std::move(sources));
+    return true;
+}
+
+void MainWindow::setSourceSpec(const SourceSpec& spec)
+{
+    m_sourceSpec = spec;
+    if (m_comboSource) {
+        QSignalBlocker b(m_comboSource);
+        m_comboSource->setCurrentIndex(static_cast<int>(spec.kind));
+    }
+    if (m_spnReplayFps) {
+        QSignalBlocker b(m_spnReplayFps);
+        m_spnReplayFps->setValue(static_cast<int>(spec.rateFps));
+        m_spnReplayFps->setEnabled(spec.kind != SourceKind::Live);
+    }
+    setCameraCount(spec.paths.empty() ? spec.cameras : static_cast<int>(spec.paths.size()));
+}
+
+void MainWindow::setCameraCount(int count)
+{
+    m_cameraCount = std::clamp(count, 2, kMaxCameras);
+    if (m_spnCameraCount) {
+        QSignalBlocker b(m_spnCameraCount);
+        m_spnCameraCount->setValue(m_cameraCount);
+    }
+    if (m_comboCompareCam) {
+        QSignalBlocker b(m_comboCompareCam);
+        m_comboCompareCam->clear();
+        for (int c = 1; c < m_cameraCount; ++c) m_comboCompareCam->addItem(QString("CAM%1").arg(c + 1));
+    }
+    m_activeAdjCam = std::clamp(m_activeAdjCam, 1, m_cameraCount);
+    if (m_comboAdjCam) {
+        QSignalBlocker b(m_comboAdjCam);
+        m_comboAdjCam->clear();
+        for (int c = 0; c < m_cameraCount; ++c) m_comboAdjCam->addItem(QString("CAM %1").arg(c + 1));
+        m_comboAdjCam->setCurrentIndex(m_activeAdjCam - 1);
+    }
+    for (int c = 0; c < m_seriesCam.size(); ++c) {
+        const bool used = c < m_cameraCount;
+        m_seriesCam[c]->setVisible(used);
+        if (!m_chart) continue;
+        for (QLegendMarker* marker : m_chart->legend()->markers(m_seriesCam[c])) marker->setVisible(used);
+    }
+    setCompareCam(std::min(m_compareCam, m_cameraCount - 1));
+    updateLensIndicator();
+}
+
+void MainWindow::setCompareCam(int cam)
+{
+    m_compareCam = std::clamp(cam, 1, m_cameraCount - 1);
+    if (m_comboCompareCam) {
+        QSignalBlocker b(m_comboCompareCam);
+        m_comboCompareCam->setCurrentIndex(m_compareCam - 1);
+    }
+    if (m_lblFlipSection) m_lblFlipSection->setText(QString("FLIP CAM%1").arg(m_compareCam + 1));
+    if (m_chkFlipHor2) {
+        QSignalBlocker b(m_chkFlipHor2);
+        m_chkFlipHor2->setChecked(m_flips[m_compareCam].hor);
+    }
+    if (m_chkFlipVer2) {
+        QSignalBlocker b(m_chkFlipVer2);
+        m_chkFlipVer2->setChecked(m_flips[m_compareCam].ver);
+    }
+    if (m_view2) m_view2->setPlaceholder(QString("CAM %1").arg(m_compareCam + 1));
+    if (m_frames.size() > static_cast<size_t>(m_compareCam)) updateView();
+}
+
+bool MainWindow::undistortActive(int cam) const
+{
+    return m_chkUndistort && m_chkUndistort->isChecked() && m_lens[cam].valid();
+}
+
+double MainWindow::focusOf(int cam) const
+{
+    return cam >= 0 && cam < static_cast<int>(m_lastFocus.size()) ? m_lastFocus[cam] : 0.0;
 }
 
 void MainWindow::closeCameras()
@@ -3489,6 +4627,9 @@ void MainWindow::closeCameras()
     m_camerasOpen = false;
 
     if (m_comboCamSet) m_comboCamSet->setEnabled(true);
+    if (m_spnCameraCount) m_spnCameraCount->setEnabled(true);
+    if (m_comboSource) m_comboSource->setEnabled(true);
+    if (m_chkHighBitDepth) m_chkHighBitDepth->setEnabled(true);
 
     if (m_btnFabStream) {
 
@@ -3506,11 +4647,10 @@ void MainWindow::closeCameras()
         }
     }
 
-    m_frame1.release();
-    m_frame2.release();
+    m_frames.clear();
 
     if (m_view1) { m_view1->setOverlayText("", false); m_view1->setPlaceholder("CAM 1"); }
-    if (m_view2) { m_view2->setOverlayText("", false); m_view2->setPlaceholder("CAM 2"); }
+    if (m_view2) { m_view2->setOverlayText("", false); m_view2->setPlaceholder(QString("CAM %1").arg(m_compareCam + 1)); }
     if (m_resultView) { m_resultView->setOverlayText("", false); m_resultView->setPlaceholder("DIFF"); }
 
     if (m_motionIndicator) {
@@ -3523,55 +4663,6 @@ void MainWindow::closeCameras()
     m_statusBar->showMessage("Cameras closed.", 2000);
 }
 
-cv::Mat MainWindow::fuseCameras(const cv::Mat& a, const cv::Mat& b)
-{
-    cv::Mat out;
-    cv::addWeighted(a, 0.5, b, 0.5, 0.0, out);
-    return out;
-}
-
-cv::Mat MainWindow::applyDiffView(const cv::Mat& d1, const cv::Mat& d2)
-{
-    cv::Mat diff;
-
-    cv::Mat a = d1, b = d2;
-    if (b.size() != a.size()) cv::resize(b, b, a.size());
-
-    cv::Mat ga, gb;
-    if (a.channels() == 3) cv::cvtColor(a, ga, cv::COLOR_BGR2GRAY);
-    else ga = a;
-    if (b.channels() == 3) cv::cvtColor(b, gb, cv::COLOR_BGR2GRAY);
-    else gb = b;
-
-    const double f1 = m_lastFocus1;
-    const double f2 = m_lastFocus2;
-    if (f1 > 1.0 && f2 > 1.0) {
-        const double ratio = (f1 > f2) ? (f1 / f2) : (f2 / f1);
-        if (ratio > 1.15) {
-            const double sigma = std::min(6.0, 0.6 * std::sqrt(ratio - 1.0));
-            int k = static_cast<int>(std::ceil(sigma * 3.0)) | 1;
-            if (k < 3) k = 3;
-            if (k > 31) k = 31;
-            if (f1 > f2) cv::GaussianBlur(ga, ga, cv::Size(k, k), sigma);
-            else         cv::GaussianBlur(gb, gb, cv::Size(k, k), sigma);
-        }
-    }
-
-    cv::absdiff(ga, gb, diff);
-
-    if (m_noiseFloor > 0) {
-        cv::threshold(diff, diff, m_noiseFloor, 255, cv::THRESH_TOZERO);
-    }
-
-    if (m_chkStretch && m_chkStretch->isChecked()) {
-        cv::normalize(diff, diff, 0, 255, cv::NORM_MINMAX);
-    }
-
-    cv::applyColorMap(diff, diff, cv::COLORMAP_JET);
-
-    return diff;
-}
-
 bool MainWindow::eventFilter(QObject* obj, QEvent* event)
 {
     if (obj == m_videoArea
@@ -3583,44 +4674,73 @@ bool MainWindow::eventFilter(QObject* obj, QEvent* event)
     return QMainWindow::eventFilter(obj, event);
 }
 
-void MainWindow::onFramesProcessed(cv::Mat f1, cv::Mat f2, double focus1, double focus2, bool motionDetected, qint64 frameCount)
+void MainWindow::onFramesProcessed()
 {
-    if (m_worker) m_worker->m_pendingFrames.fetch_sub(1);
+    if (!m_worker) return;
 
-    if (!m_camerasOpen) return;
+    FramePacket pair;
+    if (!m_worker->takeLatest(pair) || !pair.meta) return;
 
-    m_frame1 = f1;
-    m_frame2 = f2;
-    m_lastFocus1 = focus1;
-    m_lastFocus2 = focus2;
+    if (!m_camerasOpen) return;
+    StageMeter::Scope busy(m_presentMeter);
+
+    const FrameMeta& meta = *pair.meta;
+    if (pair.frames.size() < 2 || meta.cams.size() != pair.frames.size()) return;
+    const bool motionDetected = meta.motion;
+    const qint64 frameCount = meta.frameCount;
+    const double skewMs = meta.skewMs;
+    m_droppedFrames = meta.droppedFrames;
+    if (m_pendingExposureGen != 0
+        && std::all_of(meta.cams.begin(), meta.cams.end(),
+                       [this](const CameraMeta& c) { return c.exposureGen >= m_pendingExposureGen; })) {
+        m_pendingExposureGen = 0;
+        m_statusBar->showMessage(QString("Exposure applied from frame %1").arg(frameCount), 2000);
+    }
+
+    m_frames = pair.frames;
+    m_frameMeta = pair.meta;
+    m_lastFocus.resize(meta.cams.size());
+    for (size_t c = 0; c < meta.cams.size(); ++c) m_lastFocus[c] = meta.cams[c].focus;
+    m_lastSkewMs = skewMs;
     m_frameCount = frameCount;
 
-    if (m_focusViewActive) {
-        if (m_lblFocus1Big) m_lblFocus1Big->setText(QString::number(static_cast<int>(focus1)));
-        if (m_lblFocus2Big) m_lblFocus2Big->setText(QString::number(static_cast<int>(focus2)));
-
-        if (m_seriesCam1 && m_seriesCam2 && m_chart) {
-            m_seriesCam1->append(frameCount, focus1);
-            m_seriesCam2->append(frameCount, focus2);
+    if (m_fpsPill) {
+        QString pill = QString::fromUtf8("STREAMING  \u0394%1 ms").arg(skewMs, 0, 'f', 1);
+        if (m_droppedFrames > 0) pill += QString("  DROP %1").arg(m_droppedFrames);
+        m_fpsPill->setText(pill);
+    }
 
-            int diff1 = m_seriesCam1->count() - m_maxHistory;
-            if (diff1 > 0) m_seriesCam1->removePoints(0, diff1);
-            int diff2 = m_seriesCam2->count() - m_maxHistory;
-            if (diff2 > 0) m_seriesCam2->removePoints(0, diff2);
+    if (m_focusViewActive) {
+        if (m_lblFocus1Big) m_lblFocus1Big->setText(QString::number(static_cast<int>(focusOf(0))));
+        if (m_lblFocus2Big) m_lblFocus2Big->setText(QString::number(static_cast<int>(focusOf(m_compareCam))));
+        auto detail = [&meta](int c) {
+            if (c < 0 || c >= static_cast<int>(meta.cams.size())) return QString("TEN 0  BREN 0");
+            return QString("TEN %1  BREN %2").arg(qRound(meta.cams[c].tenengrad)).arg(qRound(meta.cams[c].brenner));
+        };
+        if (m_lblFocus1Detail) m_lblFocus1Detail->setText(detail(0));
+        if (m_lblFocus2Detail) m_lblFocus2Detail->setText(detail(m_compareCam));
+
+        if (!m_seriesCam.isEmpty() && m_chart) {
+            const int n = std::min(static_cast<int>(m_lastFocus.size()), static_cast<int>(m_seriesCam.size()));
+            for (int c = 0; c < n; ++c) {
+                m_seriesCam[c]->append(frameCount, m_lastFocus[c]);
+                const int excess = m_seriesCam[c]->count() - m_maxHistory;
+                if (excess > 0) m_seriesCam[c]->removePoints(0, excess);
+            }
 
             auto axes = m_chart->axes(Qt::Horizontal);
             if (!axes.isEmpty()) {
                 axes.first()->setRange(std::max(0LL, frameCount - m_maxHistory), frameCount);
             }
 
-
             auto seriesMax = [](QLineSeries* s) {
                 double m = 0.0;
                 const auto pts = s->points();
                 for (const QPointF& p : pts) if (p.y() > m) m = p.y();
                 return m;
             };
-            const double rawMax = std::max(seriesMax(m_seriesCam1), seriesMax(m_seriesCam2));
+            double rawMax = 0.0;
+            for (QLineSeries* s : m_seriesCam) rawMax = std::max(rawMax, seriesMax(s));
             auto niceCeil = [](double v) {
                 if (v <= 0.0) return 100.0;
                 const double padded = v * 1.10;
@@ -3647,135 +4767,137 @@ void MainWindow::onFramesProcessed(cv::Mat f1, cv::Mat f2, double focus1, double
         }
     }
 
-    if (m_motionActive != motionDetected) {
-        m_motionActive = motionDetected;
-        if (m_motionIndicator) {
-            if (m_motionActive) {
-                m_motionIndicator->setText(QString::fromUtf8("\u25CF Motion"));
-                m_motionIndicator->setStyleSheet(QString("color:%1; font-weight:600;").arg(T::err));
-            } else {
-                m_motionIndicator->setText(QString::fromUtf8("\u25CF Stable"));
-                m_motionIndicator->setStyleSheet(QString("color:%1; font-weight:600;").arg(T::ok));
-            }
+    /* The indicator names the cameras that moved and how many regions each
+       reported; the tooltip carries the per-camera ratios. */
+    QStringList movingCams, motionDetails;
+    for (size_t c = 0; c < meta.cams.size(); ++c) {
+        const CameraMeta& cm = meta.cams[c];
+        if (cm.motion > meta.params.motionThr)
+            movingCams << QString("CAM%1 \u00d7%2").arg(c + 1).arg(cm.motionRegions.size());
+        motionDetails << QString("CAM%1: %2% moving, %3 regions").arg(c + 1)
+                         .arg(cm.motion * 100.0, 0, 'f', 1).arg(cm.motionRegions.size());
+    }
+    m_motionActive = motionDetected;
+    if (m_motionIndicator) {
+        const QString text = movingCams.isEmpty() ? QString::fromUtf8("\u25CF Stable")
+                                                  : QString::fromUtf8("\u25CF Motion  ") + movingCams.join("  ");
+        if (m_motionIndicator->text() != text) {
+            m_motionIndicator->setText(text);
+            m_motionIndicator->setStyleSheet(QString("color:%1; font-weight:600;").arg(m_motionActive ? T::err : T::ok));
         }
+        m_motionIndicator->setToolTip(motionDetails.join("\n"));
     }
 
+    updateStageStats();
+    validateCachedAlignment();
+    trackAlignment();
     updateView();
 }
 
+void MainWindow::updateStageStats()
+{
+    /* Occupancy per pipeline stage over the last second; the capture stage
+       is reported as how full the sync queues are. A stage near 100% is
+       the bottleneck. */
+    const int64_t now = monotonicNowNs();
+    if (now - m_stageSampleNs < 1000000000LL) return;
+    m_stageSampleNs = now;
+
+    const StageMeter::Sample condition = m_worker->meter().sample();
+    const StageMeter::Sample compose   = m_composer->meter().sample();
+    const StageMeter::Sample present   = m_presentMeter.sample();
+    auto pct = [](double v) { return static_cast<int>(v * 100.0 + 0.5); };
+    QString stats = QString("Capture queue %1% | Condition %2% (%3/s) | Compose %4% (%5/s) | Present %6%"
+                            " | Compose skipped %7")
+        .arg(pct(m_worker->queueFill()))
+        .arg(pct(condition.occupancy)).arg(condition.items)
+        .arg(pct(compose.occupancy)).arg(compose.items)
+        .arg(pct(present.occupancy))
+        .arg(m_composer->replacedJobs());
+    const int64_t ringBytes = m_worker->temporalBytes();
+    if (ringBytes > 0) stats += QString(" | Frame ring %1 MB").arg(ringBytes / 1e6, 0, 'f', 1);
+    if (m_fpsPill) m_fpsPill->setToolTip(stats);
+}
+
 void MainWindow::updateView()
 {
     updateEccPill();
 
-    if (m_frame1.empty() || m_frame2.empty()) return;
-
-    cv::Mat f1 = m_frame1.clone();
-    cv::Mat f2 = m_frame2.clone();
+    const int n = static_cast<int>(m_frames.size());
+    if (n < 2 || m_compareCam >= n || !m_composer) return;
+
+    /* Composition runs on ViewComposer; onViewComposed() presents it. */
+    ComposeJob job;
+    job.frames     = m_frames;
+    job.meta       = m_frameMeta;
+    job.view       = currentViewMeta();
+    job.view.eccWarps = m_eccWarps;
+    m_frameView    = job.view;
+    if (job.view.undistort) {
+        job.lenses.assign(m_lens.begin(), m_lens.begin() + n);
+        job.lensGen = m_lensGen;
+    }
+    job.focus      = m_lastFocus;
+    job.noiseFloor = m_noiseFloor;
+    job.view1Size  = m_view1->size();
+    job.view2Size  = m_view2->size();
+    job.resultSize = m_resultView->size();
+    m_composer->submit(std::move(job));
+}
 
-    if (!m_manualAdj1.isIdentity()) {
-        cv::Mat H = buildManualHomography(m_manualAdj1, f1.size());
-        cv::Mat warped;
-        cv::warpPerspective(f1, warped, H, f1.size(), cv::INTER_LINEAR);
-        f1 = warped;
-    }
-    if (!m_manualAdj2.isIdentity()) {
-        cv::Mat H = buildManualHomography(m_manualAdj2, f2.size());
-        cv::Mat warped;
-        cv::warpPerspective(f2, warped, H, f2.size(), cv::INTER_LINEAR);
-        f2 = warped;
-    }
+void MainWindow::onViewComposed()
+{
+    ComposedView out;
+    if (!m_composer || !m_composer->takeLatest(out)) return;
+    /* Late result from a session that was closed in the meantime. */
+    if (!m_camerasOpen || m_frames.empty()) return;
+    StageMeter::Scope busy(m_presentMeter);
 
-    const bool eccReady = m_isAligned && !m_eccWarpMatrix.empty();
-    const bool wantAlign = m_chkAlign && m_chkAlign->isChecked() && eccReady;
-    const bool wantFusion = m_chkFusion && m_chkFusion->isChecked() && eccReady;
+    /* The composer adds what it measured, e.g. the applied shift. */
+    if (out.meta == m_frameMeta) m_frameView = out.view;
 
-    cv::Mat warpedF2 = f2;
-    if (wantAlign || wantFusion) {
-        try {
-            cv::warpPerspective(f2, warpedF2, m_eccWarpMatrix, f1.size(), cv::INTER_LINEAR);
-        }
-        catch (const cv::Exception& e) {
-            std::cerr << "Warp error: " << e.what() << std::endl;
-            warpedF2 = f2;
-        }
+    if (out.view.shiftAlign) {
+        m_phaseShift = out.view.shift;
+        m_phaseResponse = out.view.shiftResponse;
+        m_phaseFallback = out.view.shiftFallback;
+        updateEccPill();
     }
 
-    cv::Mat alignedF2 = wantAlign ? warpedF2 : f2;
-    if (wantFusion) {
-        f1 = fuseCameras(f1, warpedF2);
+    if (out.showPeaks) {
+        m_lblPeakInfo->setText(QString("Peak 1: %1 | Peak %2: %3")
+            .arg(static_cast<int>(out.peak1))
+            .arg(out.compareCam + 1)
+            .arg(static_cast<int>(out.peak2)));
     }
 
-    bool showPeaks = m_btnPeakIntensities && m_btnPeakIntensities->isChecked();
-    cv::Point maxLoc1, maxLoc2;
-    double maxVal1 = 0, maxVal2 = 0;
-
-    if (showPeaks) {
-        cv::Mat g1, g2;
-        if (f1.channels() == 3) cv::cvtColor(f1, g1, cv::COLOR_BGR2GRAY);
-        else g1 = f1;
-
-        if (alignedF2.channels() == 3) cv::cvtColor(alignedF2, g2, cv::COLOR_BGR2GRAY);
-        else g2 = alignedF2;
-
-        cv::Mat blur1, blur2;
-        cv::blur(g1, blur1, cv::Size(31, 31));
-        cv::blur(g2, blur2, cv::Size(31, 31));
-
-        cv::minMaxLoc(blur1, nullptr, nullptr, nullptr, &maxLoc1);
-        cv::minMaxLoc(blur2, nullptr, nullptr, nullptr, &maxLoc2);
-
-        cv::minMaxLoc(g1, nullptr, &maxVal1, nullptr, nullptr);
-        cv::minMaxLoc(g2, nullptr, &maxVal2, nullptr, nullptr);
-
-        m_lblPeakInfo->setText(QString("Peak 1: %1 | Peak 2: %2")
-            .arg(static_cast<int>(maxVal1))
-            .arg(static_cast<int>(maxVal2)));
-    }
-
-    auto drawTarget = [](cv::Mat& img, cv::Point pt, const cv::Scalar& color, const std::string& label) {
-        cv::circle(img, pt, 20, color, 2);
-        cv::line(img, cv::Point(pt.x - 10, pt.y), cv::Point(pt.x + 10, pt.y), color, 2);
-        cv::line(img, cv::Point(pt.x, pt.y - 10), cv::Point(pt.x, pt.y + 10), color, 2);
-        cv::putText(img, label, cv::Point(pt.x + 25, pt.y + 5), cv::FONT_HERSHEY_SIMPLEX, 0.6, color, 2);
-    };
-
-    if (!m_isDiffMode)
+    if (!out.diffMode)
     {
         m_resultView->hide();
         m_splitter->show();
 
-        if (showPeaks) {
-            if (f1.channels() == 1) cv::cvtColor(f1, f1, cv::COLOR_GRAY2BGR);
-            if (alignedF2.channels() == 1) cv::cvtColor(alignedF2, alignedF2, cv::COLOR_GRAY2BGR);
-            drawTarget(f1, maxLoc1, cv::Scalar(0, 255, 255), "Max 1");
-            drawTarget(alignedF2, maxLoc2, cv::Scalar(0, 255, 255), "Max 2");
-        }
-
         m_view1->setOverlayColor(QColor(0x4e, 0xc9, 0xb0));
-        m_view1->setOverlayText(QString("CAM1  Focus %1").arg(static_cast<int>(m_lastFocus1)), false);
+        m_view1->setOverlayText(QString("CAM1  Focus %1").arg(static_cast<int>(out.focus1)), false);
         m_view2->setOverlayColor(QColor(0xce, 0x91, 0x78));
-        m_view2->setOverlayText(QString("CAM2  Focus %1").arg(static_cast<int>(m_lastFocus2)), true);
+        m_view2->setOverlayText(QString("CAM%1  Focus %2").arg(out.compareCam + 1)
+                                .arg(static_cast<int>(out.focus2)), true);
 
-        displayMat(m_view1, f1);
-        displayMat(m_view2, alignedF2);
+        if (!out.image1.isNull()) m_view1->setImage(out.image1);
+        if (!out.image2.isNull()) m_view2->setImage(out.image2);
     }
     else
     {
         m_splitter->hide();
         m_resultView->show();
 
-        cv::Mat diff = applyDiffView(f1, alignedF2);
-
-        if (showPeaks) {
-            drawTarget(diff, maxLoc1, cv::Scalar(0, 255, 255), "P1");
-            drawTarget(diff, maxLoc2, cv::Scalar(255, 0, 255), "P2");
-        }
-
         m_resultView->setOverlayColor(QColor(0xff, 0xff, 0xff));
-        m_resultView->setOverlayText("DIFF", false);
+        m_resultView->setOverlayText(QString("DIFF 1-%1").arg(out.compareCam + 1), false);
 
-        m_lastDiffResult = diff.clone();
-        displayMat(m_resultView, diff);
+        /* The diff, its packet and the view settings travel together, so a
+           snapshot always describes exactly these pixels. */
+        m_lastDiffResult = out.diff;
+        m_lastDiffMeta = out.meta;
+        m_lastDiffView = out.view;
+        if (!out.diffImage.isNull()) m_resultView->setImage(out.diffImage);
     }
 }
 
@@ -3790,212 +4912,522 @@ void MainWindow::calibrateAlignment()
         m_statusBar->showMessage("Calibration already in progress...", 2000);
         return;
     }
-
-    cv::Mat f1 = m_frame1.clone();
-    cv::Mat f2 = m_frame2.clone();
-
-    if (f1.empty() || f2.empty()) {
-        m_statusBar->showMessage("Calibration failed: Empty frames.", 3000);
+    if (m_aligner.busy()) {
+        m_statusBar->showMessage("Previous calibration still finishing, try again shortly.", 3000);
         return;
     }
 
-    if (!m_manualAdj1.isIdentity()) {
-        cv::Mat H = buildManualHomography(m_manualAdj1, f1.size());
-        cv::Mat warped;
-        cv::warpPerspective(f1, warped, H, f1.size(), cv::INTER_LINEAR);
-        f1 = warped;
-    }
-    if (!m_manualAdj2.isIdentity()) {
-        cv::Mat H = buildManualHomography(m_manualAdj2, f2.size());
-        cv::Mat warped;
-        cv::warpPerspective(f2, warped, H, f2.size(), cv::INTER_LINEAR);
-        f2 = warped;
-    }
-
-    cv::Mat gray1, gray2;
-    if (f1.channels() == 3) cv::cvtColor(f1, gray1, cv::COLOR_BGR2GRAY);
-    else gray1 = f1.clone();
-    if (f2.channels() == 3) cv::cvtColor(f2, gray2, cv::COLOR_BGR2GRAY);
-    else gray2 = f2.clone();
-
-    if (calculateFocus(gray1) < 2.0) {
-        m_statusBar->showMessage("Error: Too dark for calibration!", 4000);
+    const int n = static_cast<int>(m_frames.size());
+    const bool empty = std::any_of(m_frames.begin(), m_frames.end(), [](const cv::Mat& f) { return f.empty(); });
+    if (n < 2 || empty) {
+        m_statusBar->showMessage("Calibration failed: Empty frames.", 3000);
         return;
     }
 
+    /* Only frame headers and small state are copied here; undistortion and
+       adjustment run on the calibration thread. */
+    std::vector<ManualAdjust> manual(m_manualAdj.begin(), m_manualAdj.begin() + n);
+    std::vector<LensModel> lenses(n);
+    for (int c = 0; c < n; ++c) if (undistortActive(c)) lenses[c] = m_lens[c];
+
     m_calibrating = true;
     m_btnCalibrateAlign->setEnabled(false);
     setPillState(m_eccIndicator, "warn", "CALIBRATING\u2026");
     updateEccPill();
-    m_statusBar->showMessage("Calibrating (SIFT)... please wait.");
+    m_statusBar->showMessage("Calibrating (SIFT / ORB)... please wait.");
 
     if (m_calibThread.joinable()) m_calibThread.join();
 
-    m_calibThread = std::thread([this, gray1 = std::move(gray1), gray2 = std::move(gray2)]() {
-        QString errorMsg;
-        QString modelUsed;
-        cv::Mat warpMatrix;
-        bool success = false;
-
-        auto isHomographySane = [](const cv::Mat& H, const cv::Size& imgSz) -> bool {
-            if (H.empty() || H.rows != 3 || H.cols != 3) return false;
-            cv::Mat Hd;
-            H.convertTo(Hd, CV_64F);
-            double det = cv::determinant(Hd);
-            if (!std::isfinite(det) || std::abs(det) < 1e-4 || std::abs(det) > 1e4) return false;
-
-            std::vector<cv::Point2f> corners = {
-                {0.f, 0.f},
-                {static_cast<float>(imgSz.width - 1), 0.f},
-                {static_cast<float>(imgSz.width - 1), static_cast<float>(imgSz.height - 1)},
-                {0.f, static_cast<float>(imgSz.height - 1)}
-            };
-            std::vector<cv::Point2f> warped;
-            cv::perspectiveTransform(corners, warped, Hd);
-            for (const auto& p : warped) {
-                if (!std::isfinite(p.x) || !std::isfinite(p.y)) return false;
-                if (std::abs(p.x) > 4.0 * imgSz.width || std::abs(p.y) > 4.0 * imgSz.height) return false;
-            }
-            auto edgeLen = [](cv::Point2f a, cv::Point2f b) {
-                return std::hypot(a.x - b.x, a.y - b.y);
-            };
-            double e0 = edgeLen(warped[0], warped[1]);
-            double e1 = edgeLen(warped[1], warped[2]);
-            double e2 = edgeLen(warped[2], warped[3]);
-            double e3 = edgeLen(warped[3], warped[0]);
-            double srcE0 = imgSz.width;
-            double srcE1 = imgSz.height;
-            auto ratio = [](double a, double b) { return (a > b) ? (a / b) : (b / a); };
-            if (ratio(e0, srcE0) > 5.0 || ratio(e2, srcE0) > 5.0) return false;
-            if (ratio(e1, srcE1) > 5.0 || ratio(e3, srcE1) > 5.0) return false;
-            if (ratio(e0, e2) > 4.0 || ratio(e1, e3) > 4.0) return false;
-            return true;
-        };
+    m_calibThread = std::thread([this, frames = m_frames, manual = std::move(manual), lenses = std::move(lenses)]() {
+        const int n = static_cast<int>(frames.size());
+        /* Alignment is solved in the same space it is applied in. grays[0]
+           is the reference; every other camera is matched against it. */
+        std::vector<cv::Mat> grays(n);
+        for (int c = 0; c < n; ++c) {
+            const cv::Mat f = adjustFrame(frames[c], manual[c], &lenses[c]);
+            if (f.channels() == 3) cv::cvtColor(f, grays[c], cv::COLOR_BGR2GRAY);
+            else grays[c] = f;
+            /* Feature detectors are 8-bit only. */
+            grays[c] = toDisplay8(grays[c]);
+        }
 
-        const cv::Size imgSz = gray1.size();
-
-        auto runWithDetector = [&](cv::Ptr<cv::Feature2D> detector,
-                                   cv::Ptr<cv::DescriptorMatcher> matcher,
-                                   float loweRatio,
-                                   const QString& tag,
-                                   QString& outErr,
-                                   QString& outModel,
-                                   cv::Mat& outWarp) -> bool {
-            std::vector<cv::KeyPoint> kp1, kp2;
-            cv::Mat des1, des2;
-            detector->detectAndCompute(gray1, cv::noArray(), kp1, des1);
-            detector->detectAndCompute(gray2, cv::noArray(), kp2, des2);
-
-            if (des1.empty() || des2.empty() || kp1.size() < 16 || kp2.size() < 16) {
-                outErr = tag + ": insufficient keypoints";
-                return false;
+        if (measureFocus(grays[0]).laplacian < 2.0) {
+            QMetaObject::invokeMethod(this, [this]() {
+                m_statusBar->showMessage("Error: Too dark for calibration!", 4000);
+                if (!m_isAligned) setPillState(m_eccIndicator, "err", "NOT CALIBRATED");
+                else if (m_validateAlign) setPillState(m_eccIndicator, "warn", "CACHED");
+                else setPillState(m_eccIndicator, "ok", "MATRIX READY");
+                m_btnCalibrateAlign->setEnabled(true);
+                m_calibrating = false;
+                updateEccPill();
+            });
+            return;
+        }
+
+        QStringList errors;
+        QStringList models;
+        std::vector<cv::Mat> warps(n);
+        bool success = true;
+
+        /* solve() returns as soon as every camera is decided; a detector
+           that lost the race finishes on a thread m_aligner owns. */
+        const std::vector<AlignEstimate> estimates =
+            m_aligner.solve(grays[0], std::vector<cv::Mat>(grays.begin() + 1, grays.end()));
+        for (int c = 1; c < n; ++c) {
+            const QString cam = QString("CAM%1").arg(c + 1);
+            const AlignEstimate& e = estimates[c - 1];
+            if (e.ok) {
+                warps[c] = e.warp;
+                models << cam + " " + QString::fromStdString(e.model);
+            } else {
+                errors << cam + ": " + QString::fromStdString(e.error);
             }
+            success = success && e.ok;
+        }
 
-            std::vector<std::vector<cv::DMatch>> knn;
-            matcher->knnMatch(des2, des1, knn, 2);
-
-            std::vector<cv::Point2f> ptsSrc, ptsDst;
-            ptsSrc.reserve(knn.size());
-            ptsDst.reserve(knn.size());
-            for (const auto& pair : knn) {
-                if (pair.size() < 2) continue;
-                if (pair[0].distance < loweRatio * pair[1].distance) {
-                    ptsSrc.push_back(kp2[pair[0].queryIdx].pt);
-                    ptsDst.push_back(kp1[pair[0].trainIdx].pt);
-                }
+        const QString errorMsg = errors.join("; ");
+        const QString modelUsed = models.join(", ");
+        if (!success) warps.clear();
+        QMetaObject::invokeMethod(this, [this, success, warps, estimates, errorMsg, modelUsed]() {
+            ++m_alignGen;
+            m_alignDrift = 0.0;
+            m_validateAlign = false;
+            if (success) {
+                m_eccWarps = warps;
+                m_alignBaseline = warps;
+                m_alignTarget = warps;
+                m_isAligned = true;
+                saveCachedAlignment(estimates);
+                setPillState(m_eccIndicator, "ok", "MATRIX READY");
+                m_statusBar->showMessage("Alignment OK [" + modelUsed + "]", 3000);
+            }
+            else {
+                m_eccWarps.clear();
+                m_alignBaseline.clear();
+                m_alignTarget.clear();
+                m_isAligned = false;
+                setPillState(m_eccIndicator, "err", "NOT CALIBRATED");
+                m_statusBar->showMessage("Alignment failed (low texture / too different views): " + errorMsg, 5000);
             }
+            m_btnCalibrateAlign->setEnabled(true);
+            m_calibrating = false;
+            updateEccPill();
+        });
+    });
+}
 
-            if (ptsSrc.size() < 12) {
-                outErr = QString("%1: only %2 good matches").arg(tag).arg(static_cast<int>(ptsSrc.size()));
-                return false;
+void MainWindow::trackAlignment()
+{
+    /* Estimation every two seconds, easing at 10 Hz: each eased step
+       rebuilds the composer's remap table, so it is not done per frame. */
+    static constexpr int64_t kTrackIntervalNs = 2000000000LL;
+    static constexpr int64_t kTrackStepNs     = 100000000LL;
+    /* Estimates correlating worse than this, or jumping further than a
+       mount can drift between two runs, are rejected. */
+    static constexpr double kMinRho    = 0.7;
+    static constexpr double kMaxJumpPx = 20.0;
+
+    if (!m_isAligned || m_validateAlign || !m_chkTrackAlign || !m_chkTrackAlign->isChecked()) return;
+    const int64_t now = monotonicNowNs();
+    if (now - m_trackStepNs >= kTrackStepNs) {
+        m_trackStepNs = now;
+        easeAlignment();
+    }
+    if (m_trackBusy || m_calibrating || now - m_trackStartNs < kTrackIntervalNs) return;
+    m_trackStartNs = now;
+
+    startAlignRefinement([this](const std::vector<AlignRefinement>& refined, const cv::Size& refSize) {
+        double drift = 0.0;
+        for (size_t c = 1; c < refined.size() && c < m_alignTarget.size(); ++c) {
+            const AlignRefinement& r = refined[c];
+            if (!r.ok || m_alignBaseline[c].empty()) continue;
+            if (r.rho < kMinRho || r.jump > kMaxJumpPx) {
+                std::cerr << "[align] CAM" << c + 1 << " estimate rejected (rho " << r.rho
+                          << ", jump " << r.jump << " px)" << std::endl;
+                continue;
             }
+            m_alignTarget[c] = cv::Mat(r.H);
+            cv::Mat b;
+            m_alignBaseline[c].convertTo(b, CV_64F);
+            const double d = cornerDisplacement(r.H, cv::Matx33d(b.ptr<double>()), refSize);
+            std::cerr << "[align] CAM" << c + 1 << " drift " << d << " px" << std::endl;
+            drift = std::max(drift, d);
+        }
+        m_alignDrift = drift;
+        updateEccPill();
+    });
+}
 
-            cv::Mat inliers;
-            cv::Mat H = cv::findHomography(ptsSrc, ptsDst, cv::RANSAC, 3.0, inliers, 5000, 0.999);
-            int inlierCount = cv::countNonZero(inliers);
-            double inlierRatio = static_cast<double>(inlierCount) / static_cast<double>(ptsSrc.size());
+/* Refines every calibrated camera's current target with ECC on the
+   tracking thread and hands the results to done() on the GUI thread,
+   unless the alignment was replaced in the meantime. */
+void MainWindow::startAlignRefinement(std::function<void(const std::vector<AlignRefinement>&, const cv::Size&)> done)
+{
+    const int n = static_cast<int>(m_frames.size());
+    if (n < 2 || m_alignTarget.size() != m_frames.size()) return;
+
+    /* Only frame headers and small state are copied here; undistortion,
+       adjustment and ECC all run on the tracking thread. */
+    std::vector<ManualAdjust> manual(m_manualAdj.begin(), m_manualAdj.begin() + n);
+    std::vector<LensModel> lenses(n);
+    for (int c = 0; c < n; ++c) if (undistortActive(c)) lenses[c] = m_lens[c];
+
+    m_trackBusy = true;
+    if (m_trackThread.joinable()) m_trackThread.join();
+
+    m_trackThread = std::thread([this, gen = m_alignGen, frames = m_frames, manual = std::move(manual),
+                                 lenses = std::move(lenses), guesses = m_alignTarget, done = std::move(done)]() {
+        const int n = static_cast<int>(frames.size());
+        std::vector<cv::Mat> grays(n);
+        for (int c = 0; c < n; ++c) {
+            if (c > 0 && guesses[c].empty()) continue;
+            try {
+                const cv::Mat f = adjustFrame(frames[c], manual[c], &lenses[c]);
+                cv::Mat g = f;
+                if (f.channels() == 3) cv::cvtColor(f, g, cv::COLOR_BGR2GRAY);
+                grays[c] = toDisplay8(g);
+            }
+            catch (const cv::Exception& e) {
+                std::cerr << "[align] CAM" << c + 1 << " tracking: " << e.what() << std::endl;
+            }
+        }
 
-            if (H.empty() || inlierCount < 10 || inlierRatio < 0.30) {
-                outErr = QString("%1: %2/%3 inliers (%4%)")
-                           .arg(tag).arg(inlierCount).arg(static_cast<int>(ptsSrc.size()))
-                           .arg(static_cast<int>(inlierRatio * 100));
-                return false;
+        std::vector<AlignRefinement> refined(n);
+        for (int c = 1; c < n; ++c) {
+            if (grays[0].empty() || grays[c].empty()) continue;
+            cv::Mat g;
+            guesses[c].convertTo(g, CV_64F);
+            const cv::Matx33d guess(g.ptr<double>());
+            AlignRefinement& r = refined[c];
+            r.H = guess;
+            try {
+                r.ok = refineHomographyEcc(grays[0], grays[c], r.H, r.rho);
+            }
+            catch (const cv::Exception& e) {
+                std::cerr << "[align] CAM" << c + 1 << " tracking: " << e.what() << std::endl;
             }
+            if (r.ok) r.jump = cornerDisplacement(r.H, guess, grays[0].size());
+        }
+
+        QMetaObject::invokeMethod(this, [this, gen, refined, refSize = grays[0].size(), done]() {
+            m_trackBusy = false;
+            if (gen != m_alignGen || !m_isAligned) return;
+            done(refined, refSize);
+        });
+    });
+}
+
+void MainWindow::easeAlignment()
+{
+    /* Corrections are applied a fraction of a pixel at a time so the
+       aligned view never jumps; steps below the dead band are skipped to
+       keep the remap tables cached. */
+    constexpr double kMaxStepPx  = 0.5;
+    constexpr double kDeadBandPx = 0.05;
+
+    if (m_frames.empty() || m_alignTarget.size() != m_eccWarps.size()) return;
+    const cv::Size refSize = m_frames[0].size();
+    for (size_t c = 1; c < m_eccWarps.size(); ++c) {
+        if (m_eccWarps[c].empty() || m_alignTarget[c].empty()) continue;
+        cv::Mat cur, target;
+        m_eccWarps[c].convertTo(cur, CV_64F);
+        m_alignTarget[c].convertTo(target, CV_64F);
+        const cv::Matx33d A(cur.ptr<double>()), B(target.ptr<double>());
+        const double d = cornerDisplacement(A, B, refSize);
+        if (d < kDeadBandPx) continue;
+        const double t = std::min(1.0, kMaxStepPx / d);
+        cv::Matx33d H = A * (1.0 - t) + B * t;
+        H *= 1.0 / H(2, 2);
+        /* A new matrix, never in place: queued compose jobs share the old one. */
+        m_eccWarps[c] = cv::Mat(H);
+    }
+}
 
-            if (!isHomographySane(H, imgSz)) {
-                outErr = QString("%1: homography rejected (geometry sanity check failed — likely repetitive pattern)").arg(tag);
-                return false;
+QString MainWindow::alignCacheKey() const
+{
+    /* Everything a matrix depends on: which cameras in which mode, and how
+       their frames are flipped, undistorted and adjusted before matching. */
+    QStringList parts;
+    parts << "ids=" + m_sessionCamIds.join(';');
+    parts << QString("size=%1x%2").arg(m_sessionSize.width()).arg(m_sessionSize.height());
+    for (int c = 0; c < m_sessionCamIds.size(); ++c) {
+        QString cam = QString("cam%1 flip=%2%3").arg(c + 1)
+            .arg(static_cast<int>(m_flips[c].hor)).arg(static_cast<int>(m_flips[c].ver));
+        if (undistortActive(c)) {
+            cam += QString(" lens=%1,%2").arg(m_lens[c].cameraMatrix.at<double>(0, 0), 0, 'f', 2)
+                                         .arg(m_lens[c].rms, 0, 'f', 4);
+        }
+        const ManualAdjust& a = m_manualAdj[c];
+        if (!a.isIdentity()) {
+            cam += QString(" adj=%1,%2,%3,%4,%5,%6").arg(a.tx).arg(a.ty).arg(a.scale)
+                                                    .arg(a.rx).arg(a.ry).arg(a.rz);
+        }
+        parts << cam;
+    }
+    return parts.join('|');
+}
+
+bool MainWindow::loadCachedAlignment()
+{
+    const int n = static_cast<int>(m_sessionCamIds.size());
+    if (n < 2) return false;
+    const QString key = alignCacheKey();
+    QSettings s(alignCachePath(), QSettings::IniFormat);
+    s.beginGroup(alignCacheGroup(key));
+    if (s.value("key").toString() != key) return false;
+
+    std::vector<cv::Mat> warps(n);
+    QStringList stats;
+    for (int c = 1; c < n; ++c) {
+        const QString cam = QString("cam%1/").arg(c + 1);
+        const cv::Mat H = variantListToMat(s.value(cam + "H").toList(), 3);
+        if (H.rows != 3 || H.cols != 3) return false;
+        H.convertTo(warps[c], CV_32F);
+        stats << QString("CAM%1 %2/%3 in").arg(c + 1)
+                     .arg(s.value(cam + "inliers", 0).toInt()).arg(s.value(cam + "matches", 0).toInt());
+    }
+
+    m_eccWarps = warps;
+    m_alignBaseline = warps;
+    m_alignTarget = warps;
+    m_alignDrift = 0.0;
+    m_isAligned = true;
+    m_validateAlign = true;
+    setPillState(m_eccIndicator, "warn", "CACHED");
+    updateEccPill();
+    m_statusBar->showMessage(QString("Cached alignment from %1 [%2], checking...")
+                             .arg(s.value("timestamp").toString(), stats.join(", ")), 4000);
+    std::cerr << "[align] cache hit: " << key.toStdString() << std::endl;
+    return true;
+}
+
+void MainWindow::saveCachedAlignment(const std::vector<AlignEstimate>& estimates)
+{
+    const int n = static_cast<int>(m_sessionCamIds.size());
+    if (n < 2 || m_eccWarps.size() != static_cast<size_t>(n) || estimates.size() + 1 != static_cast<size_t>(n)) return;
+    const QString key = alignCacheKey();
+    QSettings s(alignCachePath(), QSettings::IniFormat);
+    s.beginGroup(alignCacheGroup(key));
+    s.remove("");
+    s.setValue("key", key);
+    s.setValue("timestamp", QDateTime::currentDateTime().toString(Qt::ISODate));
+    for (int c = 1; c < n; ++c) {
+        const QString cam = QString("cam%1/").arg(c + 1);
+        const AlignEstimate& e = estimates[c - 1];
+        s.setValue(cam + "H", matToVariantList(m_eccWarps[c]));
+        s.setValue(cam + "inliers", e.inliers);
+        s.setValue(cam + "matches", e.matches);
+        s.setValue(cam + "ratio", e.matches > 0 ? static_cast<double>(e.inliers) / e.matches : 0.0);
+        s.setValue(cam + "model", QString::fromStdString(e.model));
+    }
+    s.endGroup();
+    s.sync();
+}
+
+void MainWindow::validateCachedAlignment()
+{
+    /* A few frames in, so auto exposure has settled; then one ECC pass per
+       camera must land close to the cached matrix. */
+    static constexpr qint64 kSettleFrames = 10;
+    static constexpr double kMinRho       = 0.7;
+    static constexpr double kMaxShiftPx   = 5.0;
+
+    if (!m_validateAlign || m_trackBusy || m_calibrating || m_frameCount < kSettleFrames) return;
+
+    startAlignRefinement([this](const std::vector<AlignRefinement>& refined, const cv::Size&) {
+        m_validateAlign = false;
+        double worst = 0.0;
+        for (size_t c = 1; c < refined.size(); ++c) {
+            const AlignRefinement& r = refined[c];
+            if (!r.ok || r.rho < kMinRho || r.jump > kMaxShiftPx) {
+                std::cerr << "[align] cached CAM" << c + 1 << " rejected (rho " << r.rho
+                          << ", shift " << r.jump << " px)" << std::endl;
+                invalidateAlignment(QString("Cached alignment no longer fits CAM%1: recalibrate.").arg(c + 1));
+                return;
             }
+            worst = std::max(worst, r.jump);
+        }
+        for (size_t c = 1; c < refined.size(); ++c) {
+            m_eccWarps[c] = cv::Mat(refined[c].H);
+            m_alignBaseline[c] = m_eccWarps[c];
+            m_alignTarget[c] = m_eccWarps[c];
+        }
+        setPillState(m_eccIndicator, "ok", "MATRIX READY");
+        m_statusBar->showMessage(QString("Cached alignment confirmed (max shift %1 px)").arg(worst, 0, 'f', 1), 3000);
+        updateEccPill();
+    });
+}
 
-            H.convertTo(outWarp, CV_32F);
-            outModel = QString("%1 %2/%3 in (%4%)")
-                         .arg(tag).arg(inlierCount).arg(static_cast<int>(ptsSrc.size()))
-                         .arg(static_cast<int>(inlierRatio * 100));
-            std::cerr << "[align] " << tag.toStdString()
-                      << " H =\n" << H << "\n"
-                      << "  inliers " << inlierCount << "/" << ptsSrc.size()
-                      << ", img " << imgSz.width << "x" << imgSz.height << std::endl;
-            return true;
-        };
+void MainWindow::captureLensTarget()
+{
+    if (!m_camerasOpen) {
+        m_statusBar->showMessage("Cameras closed.", 2000);
+        return;
+    }
 
-        try {
-            auto sift = cv::SIFT::create(0, 3, 0.04, 10.0, 1.6);
-            cv::Ptr<cv::flann::IndexParams> indexParams = cv::makePtr<cv::flann::KDTreeIndexParams>(5);
-            cv::Ptr<cv::flann::SearchParams> searchParams = cv::makePtr<cv::flann::SearchParams>(50);
-            cv::Ptr<cv::DescriptorMatcher> flann = cv::makePtr<cv::FlannBasedMatcher>(indexParams, searchParams);
-
-            success = runWithDetector(sift, flann, 0.75f, "SIFT", errorMsg, modelUsed, warpMatrix);
-
-            if (!success) {
-                auto orb = cv::ORB::create(4000);
-                cv::Ptr<cv::DescriptorMatcher> bf = cv::BFMatcher::create(cv::NORM_HAMMING, false);
-                QString orbErr, orbModel;
-                cv::Mat orbWarp;
-                if (runWithDetector(orb, bf, 0.75f, "ORB", orbErr, orbModel, orbWarp)) {
-                    success = true;
-                    warpMatrix = orbWarp;
-                    modelUsed = orbModel;
-                } else {
-                    errorMsg += " | " + orbErr;
+    if (m_calibrating) {
+        m_statusBar->showMessage("Calibration already in progress...", 2000);
+        return;
+    }
+
+    const int n = static_cast<int>(m_frames.size());
+    const bool empty = std::any_of(m_frames.begin(), m_frames.end(), [](const cv::Mat& f) { return f.empty(); });
+    if (n < 1 || empty) {
+        m_statusBar->showMessage("Lens capture failed: Empty frames.", 3000);
+        return;
+    }
+
+    /* Raw frames: the lens is measured before any correction is applied. */
+    std::vector<cv::Mat> grays(n);
+    for (int c = 0; c < n; ++c) {
+        const cv::Mat& f = m_frames[c];
+        if (f.channels() == 3) cv::cvtColor(f, grays[c], cv::COLOR_BGR2GRAY);
+        else grays[c] = f;
+        grays[c] = toDisplay8(grays[c]);
+    }
+    std::vector<std::vector<std::vector<cv::Point2f>>> views(m_lensViews.begin(), m_lensViews.begin() + n);
+
+    m_calibrating = true;
+    m_btnLensCapture->setEnabled(false);
+    m_btnCalibrateAlign->setEnabled(false);
+    setPillState(m_lensIndicator, "warn", "DETECTING\u2026");
+    m_statusBar->showMessage("Looking for the chessboard...");
+
+    if (m_calibThread.joinable()) m_calibThread.join();
+
+    m_calibThread = std::thread([this, grays = std::move(grays), views = std::move(views)]() mutable {
+        const int n = static_cast<int>(grays.size());
+        QStringList found;
+        for (int c = 0; c < n; ++c) {
+            std::vector<cv::Point2f> corners;
+            try {
+                if (findLensTarget(grays[c], corners)) {
+                    views[c].push_back(std::move(corners));
+                    found << QString("CAM%1").arg(c + 1);
                 }
             }
-        }
-        catch (const cv::Exception& e) {
-            errorMsg = QString("Feature stage failed: ") + QString::fromStdString(e.what());
+            catch (const cv::Exception& e) {
+                std::cerr << "[lens] CAM" << c + 1 << ": " << e.what() << std::endl;
+            }
         }
 
-        cv::Mat resultMatrix = success ? warpMatrix : cv::Mat();
-        QMetaObject::invokeMethod(this, [this, success, resultMatrix, errorMsg, modelUsed]() {
-            if (success) {
-                m_eccWarpMatrix = resultMatrix;
-                m_isAligned = true;
-                setPillState(m_eccIndicator, "ok", "MATRIX READY");
-                m_statusBar->showMessage("Alignment OK [" + modelUsed + "]", 3000);
+        /* Solve once every camera has enough poses. A rejected camera
+           starts over; its views were most likely blurred. */
+        const bool ready = std::all_of(views.begin(), views.end(), [](const auto& v) {
+            return static_cast<int>(v.size()) >= kLensViewsNeeded;
+        });
+        std::vector<LensModel> solved(n);
+        QStringList rejected;
+        if (ready) {
+            for (int c = 0; c < n; ++c) {
+                bool ok = false;
+                try {
+                    ok = solveLens(views[c], grays[c].size(), solved[c]);
+                }
+                catch (const cv::Exception& e) {
+                    std::cerr << "[lens] CAM" << c + 1 << ": " << e.what() << std::endl;
+                }
+                if (!ok) rejected << QString("CAM%1").arg(c + 1);
+                views[c].clear();
             }
-            else {
-                m_eccWarpMatrix.release();
-                m_isAligned = false;
-                setPillState(m_eccIndicator, "err", "NOT CALIBRATED");
-                m_statusBar->showMessage("Alignment failed (low texture / too different views): " + errorMsg, 5000);
+        }
+
+        QMetaObject::invokeMethod(this, [this, views, solved, found, rejected, ready]() {
+            const int n = static_cast<int>(views.size());
+            for (int c = 0; c < n; ++c) m_lensViews[c] = views[c];
+            if (ready) {
+                bool changed = false;
+                QStringList rms;
+                for (int c = 0; c < n; ++c) {
+                    if (!solved[c].valid()) continue;
+                    m_lens[c] = solved[c];
+                    rms << QString("CAM%1 %2 px").arg(c + 1).arg(solved[c].rms, 0, 'f', 2);
+                    changed = true;
+                }
+                if (changed) {
+                    ++m_lensGen;
+                    if (m_chkUndistort && m_chkUndistort->isChecked())
+                        invalidateAlignment("Lens model changed: recalibrate alignment.");
+                }
+                if (rejected.isEmpty()) {
+                    m_statusBar->showMessage("Lens calibrated [" + rms.join(", ") + "]", 4000);
+                } else {
+                    m_statusBar->showMessage("Lens solve rejected for " + rejected.join(", ")
+                                             + ": capture sharper poses again.", 5000);
+                }
+            } else if (found.isEmpty()) {
+                m_statusBar->showMessage("Chessboard not found.", 3000);
+            } else {
+                m_statusBar->showMessage("Chessboard found in " + found.join(", "), 2000);
             }
+            m_btnLensCapture->setEnabled(true);
             m_btnCalibrateAlign->setEnabled(true);
             m_calibrating = false;
-            updateEccPill();
+            updateLensIndicator();
+            updateView();
         });
     });
 }
 
-double MainWindow::calculateFocus(const cv::Mat& frame)
+void MainWindow::resetLensCalibration()
+{
+    if (m_calibrating) {
+        m_statusBar->showMessage("Calibration already in progress...", 2000);
+        return;
+    }
+    const bool hadModel = std::any_of(m_lens.begin(), m_lens.end(), [](const LensModel& l) { return l.valid(); });
+    for (int c = 0; c < kMaxCameras; ++c) {
+        m_lens[c] = LensModel();
+        m_lensViews[c].clear();
+    }
+    ++m_lensGen;
+    if (hadModel && m_chkUndistort && m_chkUndistort->isChecked())
+        invalidateAlignment("Lens model cleared: recalibrate alignment.");
+    updateLensIndicator();
+    updateView();
+}
+
+void MainWindow::undistortChanged()
 {
-    if (frame.empty()) return 0.0;
-    cv::Mat gray, lap;
-    if (frame.channels() == 3) cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
-    else gray = frame;
+    /* The alignment was solved in the other geometry. */
+    if (m_isAligned) invalidateAlignment("Undistortion changed: recalibrate alignment.");
+    updateLensIndicator();
+    updateView();
+}
 
-    cv::Laplacian(gray, lap, CV_64F);
-    cv::Scalar mean, stddev;
-    cv::meanStdDev(lap, mean, stddev);
-    return stddev.val[0] * stddev.val[0];
+void MainWindow::invalidateAlignment(const QString& reason)
+{
+    if (!m_isAligned) return;
+    m_eccWarps.clear();
+    m_alignBaseline.clear();
+    m_alignTarget.clear();
+    ++m_alignGen;
+    m_validateAlign = false;
+    m_isAligned = false;
+    setPillState(m_eccIndicator, "err", "NOT CALIBRATED");
+    m_statusBar->showMessage(reason, 4000);
+    updateEccPill();
+}
+
+void MainWindow::updateLensIndicator()
+{
+    if (!m_lensIndicator || m_calibrating) return;
+    int solved = 0;
+    int views = kLensViewsNeeded;
+    for (int c = 0; c < m_cameraCount; ++c) {
+        if (m_lens[c].valid()) ++solved;
+        views = std::min(views, static_cast<int>(m_lensViews[c].size()));
+    }
+    const bool undistort = m_chkUndistort && m_chkUndistort->isChecked();
+    if (views > 0) {
+        setPillState(m_lensIndicator, "warn", QString("TARGET %1/%2").arg(views).arg(kLensViewsNeeded));
+    } else if (solved == m_cameraCount) {
+        setPillState(m_lensIndicator, undistort ? "ok" : "info", undistort ? "UNDISTORT ON" : "LENS READY");
+    } else if (solved > 0) {
+        setPillState(m_lensIndicator, "warn", QString("LENS %1/%2 CAMS").arg(solved).arg(m_cameraCount));
+    } else {
+        setPillState(m_lensIndicator, "err", "NO LENS MODEL");
+    }
 }
 
 void MainWindow::pushWorkerParams()
@@ -4003,43 +5435,28 @@ void MainWindow::pushWorkerParams()
     if (!m_worker) return;
     WorkerParams p;
     p.colorMode         = m_colorMode;
-    p.flipHor2          = m_chkFlipHor2 && m_chkFlipHor2->isChecked();
-    p.flipVer2          = m_chkFlipVer2 && m_chkFlipVer2->isChecked();
+    p.flips.assign(m_flips.begin(), m_flips.begin() + m_cameraCount);
     p.motionThr         = m_motionThreshold;
+    p.motionModel       = m_comboMotionModel ? static_cast<MotionModel>(m_comboMotionModel->currentIndex())
+                                         : MotionModel::RunningAverage;
     p.bufferSize        = m_bufferSize;
+    p.temporalMode      = m_comboTemporal ? static_cast<TemporalMode>(m_comboTemporal->currentIndex())
+                                          : TemporalMode::Ema;
     p.applyBilateral    = m_chkBilateral && m_chkBilateral->isChecked();
     p.bilateralStrength = m_bilateralStrength;
     p.noiseFloor        = m_noiseFloor;
+    p.pairingPolicy     = m_comboPairing ? static_cast<PairingPolicy>(m_comboPairing->currentIndex())
+                                         : PairingPolicy::Nearest;
+    p.maxSkewMs         = m_spnMaxSkew ? m_spnMaxSkew->value() : 8;
+    p.focusGrid         = m_chkFocusMap && m_chkFocusMap->isChecked() ? kFocusGrid : cv::Size();
     m_worker->setParams(p);
 }
 
 void MainWindow::displayMat(GpuImageView* view, const cv::Mat& mat)
 {
     if (mat.empty() || view == nullptr) return;
-
-    cv::Mat src = mat;
-    const int targetW = std::max(1, view->width());
-    const int targetH = std::max(1, view->height());
-    if (src.cols > targetW * 2 || src.rows > targetH * 2) {
-        double k = std::min(static_cast<double>(targetW) / src.cols,
-                            static_cast<double>(targetH) / src.rows);
-        if (k > 0.0 && k < 1.0) {
-            cv::Mat small;
-            cv::resize(src, small, cv::Size(), k, k, cv::INTER_AREA);
-            src = small;
-        }
-    }
-
-    if (src.channels() == 1) {
-        QImage img(src.data, src.cols, src.rows, static_cast<int>(src.step), QImage::Format_Grayscale8);
-        view->setImage(img.copy());
-    }
-    else if (src.channels() == 3) {
-        cv::Mat rgb;
-        cv::cvtColor(src, rgb, cv::COLOR_BGR2RGB);
-        QImage img(rgb.data, rgb.cols, rgb.rows, static_cast<int>(rgb.step), QImage::Format_RGB888);
-        view->setImage(img.copy());
-    }
+    QImage img = toViewImage(mat, view->size());
+    if (!img.isNull()) view->setImage(img);
 }
 
 QString MainWindow::buildSnapshotBaseName(const QString& prefix) const
@@ -4091,8 +5508,8 @@ QString MainWindow::buildSnapshotBaseName(const QString& prefix) const
                 case ColorMode::GRAY_NATIVE: parts << "GRYN"; break;
             }
         }
-        if (enabled("FH") && m_chkFlipHor2 && m_chkFlipHor2->isChecked()) parts << "FH";
-        if (enabled("FV") && m_chkFlipVer2 && m_chkFlipVer2->isChecked()) parts << "FV";
+        if (enabled("FH") && m_flips[m_compareCam].hor) parts << "FH";
+        if (enabled("FV") && m_flips[m_compareCam].ver) parts << "FV";
     }
 
     QString result = prefix;
@@ -4436,6 +5853,28 @@ static bool saveWithExif(const QString& path, const cv::Mat& mat, const ExifPara
     return false;
 }
 
+/* 16-bit frames cannot go into a JPEG: they are written as 16-bit PNG with
+   the same JSON description in a text chunk. `path` gets the extension. */
+static bool saveSnapshotImage(QString& path, const cv::Mat& mat, const ExifParams& params) {
+    if (mat.depth() != CV_16U) {
+        path += ".jpg";
+        return saveWithExif(path, mat, params);
+    }
+    path += ".png";
+    cv::Mat buf;
+    QImage img;
+    if (mat.channels() == 1) {
+        buf = mat.isContinuous() ? mat : mat.clone();
+        img = QImage(buf.data, buf.cols, buf.rows, static_cast<int>(buf.step), QImage::Format_Grayscale16);
+    } else {
+        cv::cvtColor(mat, buf, cv::COLOR_BGR2RGBA);
+        img = QImage(buf.data, buf.cols, buf.rows, static_cast<int>(buf.step), QImage::Format_RGBX64);
+    }
+    img.setText("Description", QString::fromStdString(params.description));
+    QImageWriter writer(path, "png");
+    return writer.write(img);
+}
+
 void MainWindow::saveDiffSnapshot()
 {
     if (m_lastDiffResult.empty()) {
@@ -4449,7 +5888,7 @@ void MainWindow::saveDiffSnapshot()
     QString filename = buildSnapshotBaseName("diff");
     QString filePath = metricsDir + "/" + filename + ".jpg";
 
-    ExifParams p = buildExifParams("diff");
+    ExifParams p = buildExifParams("diff", m_lastDiffMeta.get(), m_lastDiffView);
     bool success = saveWithExif(filePath, m_lastDiffResult, p);
 
     if (success) {
@@ -4462,7 +5901,8 @@ void MainWindow::saveDiffSnapshot()
 
 void MainWindow::saveDualSnapshot(bool combined)
 {
-    if (m_frame1.empty() || m_frame2.empty()) {
+    const bool empty = std::any_of(m_frames.begin(), m_frames.end(), [](const cv::Mat& f) { return f.empty(); });
+    if (m_frames.size() < 2 || empty) {
         m_statusBar->showMessage("No frames available to save.", 3000);
         return;
     }
@@ -4472,115 +5912,215 @@ void MainWindow::saveDualSnapshot(bool combined)
 
     QString baseName = buildSnapshotBaseName("dual");
 
-    cv::Mat f1 = m_frame1.clone();
-    cv::Mat f2 = m_frame2.clone();
-    if (f1.channels() == 1) cv::cvtColor(f1, f1, cv::COLOR_GRAY2BGR);
-    if (f2.channels() == 1) cv::cvtColor(f2, f2, cv::COLOR_GRAY2BGR);
+    /* Pixels and metadata are taken from the same packet. */
+    const std::shared_ptr<const FrameMeta> meta = m_frameMeta;
+    const ViewMeta view = m_frameView;
+    /* Conversions below allocate, so the shared frames are never written. */
+    std::vector<cv::Mat> frames = m_frames;
+    const int depth = frames[0].depth();
+    const bool gray16 = depth == CV_16U &&
+        std::all_of(frames.begin(), frames.end(), [](const cv::Mat& f) { return f.channels() == 1; });
+    for (cv::Mat& f : frames) {
+        if (!gray16 && f.channels() == 1) cv::cvtColor(f, f, cv::COLOR_GRAY2BGR);
+        if (f.depth() != depth) f.convertTo(f, depth, pixelMax(depth) / pixelMax(f.depth()));
+    }
 
     if (combined) {
-        if (f1.rows != f2.rows) {
-            int newW = f2.cols * f1.rows / f2.rows;
-            cv::resize(f2, f2, cv::Size(newW, f1.rows));
+        const int rows = frames[0].rows;
+        for (cv::Mat& f : frames) {
+            if (f.rows != rows) cv::resize(f, f, cv::Size(f.cols * rows / f.rows, rows));
         }
         cv::Mat combo;
-        cv::hconcat(f1, f2, combo);
+        cv::hconcat(frames, combo);
         QString filename = baseName;
-        QString path = metricsDir + "/" + filename + ".jpg";
-        ExifParams p = buildExifParams("dual_combined");
-        bool ok = saveWithExif(path, combo, p);
+        QString path = metricsDir + "/" + filename;
+        ExifParams p = buildExifParams("dual_combined", meta.get(), view);
+        bool ok = saveSnapshotImage(path, combo, p);
         m_statusBar->showMessage(ok ? "Saved: " + path : "Error saving: " + path, 4000);
     } else {
-        QString filename1 = baseName + "_cam1";
-        QString filename2 = baseName + "_cam2";
-        QString path1 = metricsDir + "/" + filename1 + ".jpg";
-        QString path2 = metricsDir + "/" + filename2 + ".jpg";
-
-        ExifParams p1 = buildExifParams("dual_cam1");
-        ExifParams p2 = buildExifParams("dual_cam2");
-
-        bool ok1 = saveWithExif(path1, f1, p1);
-        bool ok2 = saveWithExif(path2, f2, p2);
-        if (ok1 && ok2)
-            m_statusBar->showMessage("Saved cam1 and cam2 snapshots.", 4000);
+        QStringList saved;
+        QString failed;
+        for (size_t c = 0; c < frames.size(); ++c) {
+            const QString suffix = QString("_cam%1").arg(c + 1);
+            ExifParams p = buildExifParams("dual" + suffix, meta.get(), view);
+            QString path = metricsDir + "/" + baseName + suffix;
+            if (saveSnapshotImage(path, frames[c], p)) saved << path;
+            else if (failed.isEmpty()) failed = path;
+        }
+        if (failed.isEmpty())
+            m_statusBar->showMessage("Saved: " + saved.join(", "), 4000);
         else
-            m_statusBar->showMessage("Error saving dual snapshots.", 4000);
+            m_statusBar->showMessage("Error saving: " + failed, 4000);
     }
 }
 
-ExifParams MainWindow::buildExifParams(const QString& mode) const
+ViewMeta MainWindow::currentViewMeta() const
+{
+    ViewMeta v;
+    v.alignEnabled = m_chkAlign && m_chkAlign->isChecked();
+    v.calibrated   = m_isAligned;
+    v.activeAdjCam = m_activeAdjCam;
+    v.compareCam   = m_compareCam;
+    v.manual.assign(m_manualAdj.begin(), m_manualAdj.begin() + m_cameraCount);
+    v.fusion       = m_chkFusion && m_chkFusion->isChecked();
+    v.undistort    = m_chkUndistort && m_chkUndistort->isChecked();
+    v.stretch      = m_chkStretch && m_chkStretch->isChecked();
+    v.trackPeaks   = m_btnPeakIntensities && m_btnPeakIntensities->isChecked();
+    v.motionActive = m_motionActive;
+    v.diffMode     = m_isDiffMode;
+    v.shiftAlign   = m_chkShiftAlign && m_chkShiftAlign->isChecked();
+    v.shiftEvery   = m_spnShiftEvery ? m_spnShiftEvery->value() : 1;
+    v.focusMap     = m_chkFocusMap && m_chkFocusMap->isChecked();
+    return v;
+}
+
+ExifParams MainWindow::buildExifParams(const QString& mode, const FrameMeta* meta, const ViewMeta& view) const
 {
     ExifParams p;
     p.make = "DualCamQt";
     p.model = mode.toStdString();
     p.software = "DualCam Analysis Tool";
 
+    /* Everything below comes from the packet the saved pixels belong to. */
+    const FrameMeta m = meta ? *meta : FrameMeta();
+    const WorkerParams& wp = m.params;
+
     QJsonObject obj;
     obj["mode"]      = mode;
     obj["timestamp"] = QDateTime::currentDateTime().toString(Qt::ISODate);
     obj["userName"]  = m_snapshotNameEdit ? m_snapshotNameEdit->text().trimmed() : QString();
 
     QString colorStr;
-    switch (m_colorMode) {
+    switch (wp.colorMode) {
         case ColorMode::COLOR:       colorStr = "RGB";        break;
         case ColorMode::GRAY_CV:     colorStr = "GRAY_CV";    break;
         case ColorMode::GRAY_NATIVE: colorStr = "GRAY_NATIVE"; break;
     }
     obj["colorMode"] = colorStr;
-    obj["flipHorizontal2"] = m_chkFlipHor2 && m_chkFlipHor2->isChecked();
-    obj["flipVertical2"]   = m_chkFlipVer2 && m_chkFlipVer2->isChecked();
-
-    obj["timeBuffer"]      = m_bufferSlider ? m_bufferSlider->value() : 0;
-    obj["motionThreshold"] = m_motionThresholdSlider ? m_motionThresholdSlider->value() : 0;
-    obj["fusion"]          = m_chkFusion && m_chkFusion->isChecked();
-    obj["bilateralFilter"] = m_chkBilateral && m_chkBilateral->isChecked();
-    obj["bilateralStrength"] = m_bilateralSlider ? m_bilateralSlider->value() : m_bilateralStrength;
-    obj["noiseFloor"]      = m_noiseFloorSlider ? m_noiseFloorSlider->value() : m_noiseFloor;
-    obj["intensityStretch"] = m_chkStretch && m_chkStretch->isChecked();
-    obj["trackPeaks"]      = m_btnPeakIntensities && m_btnPeakIntensities->isChecked();
+    obj["bitDepth"]  = m.cams.empty() ? 8 : m.cams[0].bits;
+    for (size_t c = 1; c < wp.flips.size(); ++c) {
+        obj[QString("flipHorizontal%1").arg(c + 1)] = wp.flips[c].hor;
+        obj[QString("flipVertical%1").arg(c + 1)]   = wp.flips[c].ver;
+    }
+
+    obj["timeBuffer"]      = wp.bufferSize;
+    obj["temporalMode"]    = wp.temporalMode == TemporalMode::Median ? "median"
+                           : wp.temporalMode == TemporalMode::TrimmedMean ? "trimmedMean" : "ema";
+    obj["motionThreshold"] = qRound(wp.motionThr * 100.0);
+    obj["fusion"]          = view.fusion;
+    obj["bilateralFilter"] = wp.applyBilateral;
+    obj["bilateralStrength"] = wp.bilateralStrength;
+    obj["noiseFloor"]      = wp.noiseFloor;
+    obj["intensityStretch"] = view.stretch;
+    obj["trackPeaks"]      = view.trackPeaks;
 
     QJsonObject align;
-    align["enabled"]    = m_chkAlign && m_chkAlign->isChecked();
-    align["calibrated"] = m_isAligned;
-    align["activeCam"]  = m_activeAdjCam;
+    align["enabled"]    = view.alignEnabled;
+    align["calibrated"] = view.calibrated;
+    align["undistort"]  = view.undistort;
+    align["activeCam"]  = view.activeAdjCam;
     auto adjToJson = [](const ManualAdjust& a) {
         QJsonObject o;
         o["tx"] = a.tx; o["ty"] = a.ty; o["scale"] = a.scale;
         o["rx"] = a.rx; o["ry"] = a.ry; o["rz"] = a.rz;
         return o;
     };
-    align["manualCam1"] = adjToJson(m_manualAdj1);
-    align["manualCam2"] = adjToJson(m_manualAdj2);
+    align["compareCam"] = view.compareCam + 1;
+    if (view.shiftAlign) {
+        QJsonObject shift;
+        shift["every"]    = view.shiftEvery;
+        shift["dx"]       = view.shift.x;
+        shift["dy"]       = view.shift.y;
+        shift["response"] = view.shiftResponse;
+        shift["fallback"] = view.shiftFallback;
+        align["shift"] = shift;
+    }
+    for (size_t c = 0; c < view.manual.size(); ++c)
+        align[QString("manualCam%1").arg(c + 1)] = adjToJson(view.manual[c]);
+    if (view.calibrated) {
+        for (size_t c = 1; c < view.eccWarps.size(); ++c) {
+            if (view.eccWarps[c].empty()) continue;
+            cv::Mat H;
+            view.eccWarps[c].convertTo(H, CV_64F);
+            QJsonArray rows;
+            for (int r = 0; r < H.rows; ++r) {
+                QJsonArray row;
+                for (int k = 0; k < H.cols; ++k) row.append(H.at<double>(r, k));
+                rows.append(row);
+            }
+            QJsonObject cam;
+            cam["H"] = rows;
+            align[QString("cam%1").arg(c + 1)] = cam;
+        }
+    }
     obj["alignment"] = align;
 
-    QJsonObject exposure;
-    exposure["mode"]       = m_manualExposure ? "manual" : "auto";
-    exposure["perCamera"]  = m_perCameraExposure;
-    if (m_perCameraExposure) {
-        QJsonObject c1; c1["gain"] = m_gainQ8  / 256.0; c1["shutterUs"] = m_shutterUs;
-        QJsonObject c2; c2["gain"] = m_gain2Q8 / 256.0; c2["shutterUs"] = m_shutter2Us;
-        exposure["cam1"] = c1;
-        exposure["cam2"] = c2;
-    } else {
-        exposure["gain"]      = m_gainQ8 / 256.0;
-        exposure["shutterUs"] = m_shutterUs;
+    QJsonArray capture;
+    for (const CameraMeta& c : m.cams) {
+        QJsonObject cam;
+        cam["timestampNs"] = QString::number(c.timestampNs);
+        cam["seq"]         = static_cast<qint64>(c.seq);
+        cam["motion"]      = c.motion;
+        QJsonArray regions;
+        for (const cv::Rect& r : c.motionRegions)
+            regions.append(QJsonArray{ r.x, r.y, r.width, r.height });
+        cam["motionRegions"] = regions;
+        capture.append(cam);
+    }
+    obj["capture"] = capture;
+
+    /* Offline sources have no sensor exposure to report. */
+    const ExposureSettings e1 = m.cams.empty() ? ExposureSettings() : m.cams[0].exposure;
+    if (m.live) {
+        auto expToJson = [](const ExposureSettings& e, uint32_t gen) {
+            QJsonObject o;
+            o["mode"]       = e.manual ? "manual" : "auto";
+            o["gain"]       = e.gain;
+            o["shutterUs"]  = e.shutterUs;
+            o["generation"] = static_cast<qint64>(gen);
+            return o;
+        };
+        QJsonObject exposure;
+        for (size_t c = 0; c < m.cams.size(); ++c)
+            exposure[QString("cam%1").arg(c + 1)] = expToJson(m.cams[c].exposure, m.cams[c].exposureGen);
+        obj["exposure"] = exposure;
     }
-    obj["exposure"] = exposure;
 
     QJsonObject focus;
-    focus["cam1"] = m_lastFocus1;
-    focus["cam2"] = m_lastFocus2;
+    for (size_t c = 0; c < m.cams.size(); ++c) {
+        const CameraMeta& cm = m.cams[c];
+        focus[QString("cam%1").arg(c + 1)] = cm.focus;
+        QJsonObject metrics;
+        metrics["tenengrad"] = cm.tenengrad;
+        metrics["brenner"]   = cm.brenner;
+        if (!cm.focusMap.empty()) {
+            QJsonArray rows;
+            for (int y = 0; y < cm.focusMap.rows; ++y) {
+                QJsonArray row;
+                for (int x = 0; x < cm.focusMap.cols; ++x) row.append(qRound(cm.focusMap.at<double>(y, x) * 10.0) / 10.0);
+                rows.append(row);
+            }
+            metrics["map"] = rows;
+        }
+        focus[QString("cam%1Metrics").arg(c + 1)] = metrics;
+    }
     obj["focus"] = focus;
-    obj["motionActive"] = m_motionActive;
+    obj["motion"]       = m.motion;
+    obj["motionActive"] = view.motionActive;
+    obj["pairSkewMs"]   = m.skewMs;
+    obj["droppedFrames"] = static_cast<qint64>(m.droppedFrames);
 
-    obj["diffMode"]   = m_isDiffMode;
-    obj["frameCount"] = m_frameCount;
+    obj["diffMode"]   = view.diffMode;
+    obj["frameCount"] = m.frameCount;
 
     QJsonDocument doc(obj);
     p.description = doc.toJson(QJsonDocument::Compact).toStdString();
 
-    p.exposureTimeNum = m_shutterUs;
-    p.exposureTimeDen = 1000000;
-    p.isoSpeed = static_cast<uint16_t>(m_gainQ8 * 100 / 256);
+    if (m.live && e1.manual) {
+        p.exposureTimeNum = static_cast<uint32_t>(e1.shutterUs);
+        p.exposureTimeDen = 1000000;
+        p.isoSpeed = static_cast<uint16_t>(qRound(e1.gain * 100.0));
+    }
 
     return p;
 }
@@ -4589,11 +6129,20 @@ void MainWindow::saveSettings()
 {
     QSettings s(settingsPath(), QSettings::IniFormat);
     s.setValue("colorMode", m_comboColorMode->currentIndex());
-    s.setValue("flipVer2", m_chkFlipVer2->isChecked());
-    s.setValue("flipHor2", m_chkFlipHor2->isChecked());
+    s.setValue("highBitDepth", m_chkHighBitDepth->isChecked());
+    for (int c = 1; c < kMaxCameras; ++c) {
+        s.setValue(QString("flipVer%1").arg(c + 1), m_flips[c].ver);
+        s.setValue(QString("flipHor%1").arg(c + 1), m_flips[c].hor);
+    }
     s.setValue("align", m_chkAlign->isChecked());
+    s.setValue("alignTracking", m_chkTrackAlign && m_chkTrackAlign->isChecked());
+    s.setValue("shiftAlign", m_chkShiftAlign && m_chkShiftAlign->isChecked());
+    s.setValue("shiftEvery", m_spnShiftEvery ? m_spnShiftEvery->value() : 1);
+    s.setValue("focusMap", m_chkFocusMap && m_chkFocusMap->isChecked());
     s.setValue("bufferSize", m_bufferSlider->value());
+    s.setValue("temporalMode", m_comboTemporal->currentIndex());
     s.setValue("motionThreshold", m_motionThresholdSlider->value());
+    s.setValue("motionModel", m_comboMotionModel->currentIndex());
     s.setValue("fusion", m_chkFusion->isChecked());
     s.setValue("bilateral", m_chkBilateral->isChecked());
     s.setValue("bilateralStrength", m_bilateralSlider ? m_bilateralSlider->value() : m_bilateralStrength);
@@ -4601,6 +6150,8 @@ void MainWindow::saveSettings()
     s.setValue("stretchIntensity", m_chkStretch->isChecked());
     s.setValue("trackPeaks", m_btnPeakIntensities->isChecked());
     s.setValue("appendParams", m_chkAppendParams ? m_chkAppendParams->isChecked() : false);
+    s.setValue("pairingPolicy", m_comboPairing ? m_comboPairing->currentIndex() : 0);
+    s.setValue("maxSkewMs", m_spnMaxSkew ? m_spnMaxSkew->value() : 8);
     s.beginGroup("FilenameParams");
     for (auto it = m_paramInName.constBegin(); it != m_paramInName.constEnd(); ++it) {
         s.setValue(it.key(), it.value());
@@ -4633,8 +6184,24 @@ void MainWindow::saveSettings()
         s.setValue(prefix + "ry", a.ry);
         s.setValue(prefix + "rz", a.rz);
     };
-    writeAdj("adj1/", m_manualAdj1);
-    writeAdj("adj2/", m_manualAdj2);
+    for (int c = 0; c < kMaxCameras; ++c) writeAdj(QString("adj%1/").arg(c + 1), m_manualAdj[c]);
+
+    for (int c = 0; c < kMaxCameras; ++c) {
+        const QString group = QString("lens%1").arg(c + 1);
+        const LensModel& l = m_lens[c];
+        if (!l.valid()) {
+            s.remove(group);
+            continue;
+        }
+        s.setValue(group + "/K", matToVariantList(l.cameraMatrix));
+        s.setValue(group + "/dist", matToVariantList(l.distCoeffs));
+        s.setValue(group + "/width", l.imageSize.width);
+        s.setValue(group + "/height", l.imageSize.height);
+        s.setValue(group + "/rms", l.rms);
+    }
+    s.setValue("undistort", m_chkUndistort && m_chkUndistort->isChecked());
+    s.setValue("cameraCount", m_cameraCount);
+    s.setValue("compareCam", m_compareCam + 1);
     s.setValue("activeAdjCam", m_activeAdjCam);
     s.setValue("animSpeedMs", m_animSpeedMs);
     s.setValue("animSidebarEnabled", m_animSidebarEnabled);
@@ -4656,11 +6223,20 @@ void MainWindow::loadSettings()
     m_animDialogsEnabled     = s.value("animDialogsEnabled", true).toBool();
 
     m_comboColorMode->setCurrentIndex(s.value("colorMode", 1).toInt());
-    m_chkFlipVer2->setChecked(s.value("flipVer2", false).toBool());
-    m_chkFlipHor2->setChecked(s.value("flipHor2", false).toBool());
+    m_chkHighBitDepth->setChecked(s.value("highBitDepth", false).toBool());
+    for (int c = 1; c < kMaxCameras; ++c) {
+        m_flips[c].ver = s.value(QString("flipVer%1").arg(c + 1), false).toBool();
+        m_flips[c].hor = s.value(QString("flipHor%1").arg(c + 1), false).toBool();
+    }
     m_chkAlign->setChecked(s.value("align", false).toBool());
+    if (m_chkTrackAlign) m_chkTrackAlign->setChecked(s.value("alignTracking", false).toBool());
+    if (m_spnShiftEvery) m_spnShiftEvery->setValue(s.value("shiftEvery", 1).toInt());
+    if (m_chkShiftAlign) m_chkShiftAlign->setChecked(s.value("shiftAlign", false).toBool());
+    if (m_chkFocusMap) m_chkFocusMap->setChecked(s.value("focusMap", false).toBool());
     m_bufferSlider->setValue(s.value("bufferSize", 8).toInt());
+    m_comboTemporal->setCurrentIndex(s.value("temporalMode", 0).toInt());
     m_motionThresholdSlider->setValue(s.value("motionThreshold", 5).toInt());
+    m_comboMotionModel->setCurrentIndex(s.value("motionModel", 0).toInt());
     m_chkFusion->setChecked(s.value("fusion", false).toBool());
     m_chkBilateral->setChecked(s.value("bilateral", false).toBool());
     if (m_bilateralSlider) m_bilateralSlider->setValue(s.value("bilateralStrength", 5).toInt());
@@ -4668,6 +6244,8 @@ void MainWindow::loadSettings()
     m_chkStretch->setChecked(s.value("stretchIntensity", false).toBool());
     m_btnPeakIntensities->setChecked(s.value("trackPeaks", false).toBool());
     if (m_chkAppendParams) m_chkAppendParams->setChecked(s.value("appendParams", false).toBool());
+    if (m_spnMaxSkew) m_spnMaxSkew->setValue(s.value("maxSkewMs", 8).toInt());
+    if (m_comboPairing) m_comboPairing->setCurrentIndex(s.value("pairingPolicy", 0).toInt());
     s.beginGroup("FilenameParams");
     for (const auto& spec : kFilenameParamSpecs) {
         QString key = QString::fromLatin1(spec.key);
@@ -4719,9 +6297,27 @@ void MainWindow::loadSettings()
         a.ry    = s.value(prefix + "ry",    0.0).toDouble();
         a.rz    = s.value(prefix + "rz",    0.0).toDouble();
     };
-    readAdj("adj1/", m_manualAdj1);
-    readAdj("adj2/", m_manualAdj2);
-    m_activeAdjCam = s.value("activeAdjCam", 2).toInt();
+    for (int c = 0; c < kMaxCameras; ++c) readAdj(QString("adj%1/").arg(c + 1), m_manualAdj[c]);
+
+    for (int c = 0; c < kMaxCameras; ++c) {
+        const QString group = QString("lens%1").arg(c + 1);
+        LensModel l;
+        l.cameraMatrix = variantListToMat(s.value(group + "/K").toList(), 3);
+        l.distCoeffs = variantListToMat(s.value(group + "/dist").toList(), 1);
+        l.imageSize = cv::Size(s.value(group + "/width", 0).toInt(), s.value(group + "/height", 0).toInt());
+        if (l.cameraMatrix.cols != 3 || !l.valid()) continue;
+        l.rms = s.value(group + "/rms", 0.0).toDouble();
+        m_lens[c] = l;
+    }
+    ++m_lensGen;
+    if (m_chkUndistort) {
+        QSignalBlocker b(m_chkUndistort);
+        m_chkUndistort->setChecked(s.value("undistort", false).toBool());
+    }
+    setCameraCount(s.value("cameraCount", 2).toInt());
+    setCompareCam(s.value("compareCam", 2).toInt() - 1);
+    pushWorkerParams();
+    m_activeAdjCam = std::clamp(s.value("activeAdjCam", 2).toInt(), 1, m_cameraCount);
     if (m_comboAdjCam) {
         QSignalBlocker b(m_comboAdjCam);
         m_comboAdjCam->setCurrentIndex(m_activeAdjCam - 1);
@@ -4764,11 +6360,19 @@ void MainWindow::savePreset(const QString& name)
     s.beginGroup("presets");
     s.beginGroup(name);
     s.setValue("colorMode", m_comboColorMode->currentIndex());
-    s.setValue("flipVer2", m_chkFlipVer2->isChecked());
-    s.setValue("flipHor2", m_chkFlipHor2->isChecked());
+    for (int c = 1; c < kMaxCameras; ++c) {
+        s.setValue(QString("flipVer%1").arg(c + 1), m_flips[c].ver);
+        s.setValue(QString("flipHor%1").arg(c + 1), m_flips[c].hor);
+    }
     s.setValue("align", m_chkAlign->isChecked());
+    s.setValue("alignTracking", m_chkTrackAlign && m_chkTrackAlign->isChecked());
+    s.setValue("shiftAlign", m_chkShiftAlign && m_chkShiftAlign->isChecked());
+    s.setValue("shiftEvery", m_spnShiftEvery ? m_spnShiftEvery->value() : 1);
+    s.setValue("focusMap", m_chkFocusMap && m_chkFocusMap->isChecked());
     s.setValue("bufferSize", m_bufferSlider->value());
+    s.setValue("temporalMode", m_comboTemporal->currentIndex());
     s.setValue("motionThreshold", m_motionThresholdSlider->value());
+    s.setValue("motionModel", m_comboMotionModel->currentIndex());
     s.setValue("fusion", m_chkFusion->isChecked());
     s.setValue("bilateral", m_chkBilateral->isChecked());
     s.setValue("bilateralStrength", m_bilateralSlider ? m_bilateralSlider->value() : m_bilateralStrength);
@@ -4784,8 +6388,7 @@ void MainWindow::savePreset(const QString& name)
         s.setValue(prefix + "ry", a.ry);
         s.setValue(prefix + "rz", a.rz);
     };
-    writeAdj("adj1_", m_manualAdj1);
-    writeAdj("adj2_", m_manualAdj2);
+    for (int c = 0; c < kMaxCameras; ++c) writeAdj(QString("adj%1_").arg(c + 1), m_manualAdj[c]);
     s.endGroup();
     s.endGroup();
     refreshPresetList();
@@ -4798,11 +6401,19 @@ void MainWindow::loadPreset(const QString& name)
     s.beginGroup("presets");
     s.beginGroup(name);
     m_comboColorMode->setCurrentIndex(s.value("colorMode", 1).toInt());
-    m_chkFlipVer2->setChecked(s.value("flipVer2", false).toBool());
-    m_chkFlipHor2->setChecked(s.value("flipHor2", false).toBool());
+    for (int c = 1; c < kMaxCameras; ++c) {
+        m_flips[c].ver = s.value(QString("flipVer%1").arg(c + 1), false).toBool();
+        m_flips[c].hor = s.value(QString("flipHor%1").arg(c + 1), false).toBool();
+    }
     m_chkAlign->setChecked(s.value("align", false).toBool());
+    if (m_chkTrackAlign) m_chkTrackAlign->setChecked(s.value("alignTracking", false).toBool());
+    if (m_spnShiftEvery) m_spnShiftEvery->setValue(s.value("shiftEvery", 1).toInt());
+    if (m_chkShiftAlign) m_chkShiftAlign->setChecked(s.value("shiftAlign", false).toBool());
+    if (m_chkFocusMap) m_chkFocusMap->setChecked(s.value("focusMap", false).toBool());
     m_bufferSlider->setValue(s.value("bufferSize", 8).toInt());
+    m_comboTemporal->setCurrentIndex(s.value("temporalMode", 0).toInt());
     m_motionThresholdSlider->setValue(s.value("motionThreshold", 5).toInt());
+    m_comboMotionModel->setCurrentIndex(s.value("motionModel", 0).toInt());
     m_chkFusion->setChecked(s.value("fusion", false).toBool());
     m_chkBilateral->setChecked(s.value("bilateral", false).toBool());
     if (m_bilateralSlider) m_bilateralSlider->setValue(s.value("bilateralStrength", 5).toInt());
@@ -4819,10 +6430,11 @@ void MainWindow::loadPreset(const QString& name)
         a.ry    = s.value(prefix + "ry",    0.0).toDouble();
         a.rz    = s.value(prefix + "rz",    0.0).toDouble();
     };
-    readAdj("adj1_", m_manualAdj1);
-    readAdj("adj2_", m_manualAdj2);
+    for (int c = 0; c < kMaxCameras; ++c) readAdj(QString("adj%1_").arg(c + 1), m_manualAdj[c]);
     s.endGroup();
     s.endGroup();
+    setCompareCam(m_compareCam);
+    pushWorkerParams();
     applyAdjustToWidgets();
     updateView();
     m_statusBar->showMessage("Preset '" + name + "' loaded.", 3000);
@@ -4853,48 +6465,9 @@ void MainWindow::refreshPresetList()
     }
 }
 
-cv::Mat MainWindow::buildManualHomography(const ManualAdjust& a, const cv::Size& sz) const
-{
-    const double w = sz.width;
-    const double h = sz.height;
-    const double cx = w * 0.5;
-    const double cy = h * 0.5;
-    const double f = std::max(w, h);
-
-    const double rx = a.rx * CV_PI / 180.0;
-    const double ry = a.ry * CV_PI / 180.0;
-    const double rz = a.rz * CV_PI / 180.0;
-
-    cv::Matx33d Rx(1, 0, 0,
-                   0, std::cos(rx), -std::sin(rx),
-                   0, std::sin(rx),  std::cos(rx));
-    cv::Matx33d Ry( std::cos(ry), 0, std::sin(ry),
-                    0,            1, 0,
-                   -std::sin(ry), 0, std::cos(ry));
-    cv::Matx33d Rz(std::cos(rz), -std::sin(rz), 0,
-                   std::sin(rz),  std::cos(rz), 0,
-                   0,             0,            1);
-    cv::Matx33d R = Rz * Ry * Rx;
-
-    cv::Matx33d K(f, 0, cx,
-                  0, f, cy,
-                  0, 0, 1);
-    cv::Matx33d Kinv = K.inv();
-    cv::Matx33d H3D = K * R * Kinv;
-
-    cv::Matx33d Tc1(1, 0, -cx, 0, 1, -cy, 0, 0, 1);
-    cv::Matx33d Sc(a.scale, 0, 0, 0, a.scale, 0, 0, 0, 1);
-    cv::Matx33d Tc2(1, 0,  cx, 0, 1,  cy, 0, 0, 1);
-    cv::Matx33d S = Tc2 * Sc * Tc1;
-
-    cv::Matx33d Tx(1, 0, a.tx, 0, 1, a.ty, 0, 0, 1);
-
-    return cv::Mat(Tx * S * H3D);
-}
-
 ManualAdjust& MainWindow::activeManualAdjust()
 {
-    return (m_activeAdjCam == 1) ? m_manualAdj1 : m_manualAdj2;
+    return m_manualAdj[std::clamp(m_activeAdjCam, 1, kMaxCameras) - 1];
 }
 
 void MainWindow::applyAdjustToWidgets()
@@ -4999,8 +6572,8 @@ void MainWindow::initCommands()
             int n = m_comboColorMode->count();
             if (n > 0) m_comboColorMode->setCurrentIndex((m_comboColorMode->currentIndex() + 1) % n);
         }, {}},
-        {"cmd_flip_h2", "Toggle Flip Horizontal (Cam2)", "Capture", CmdType::Toggle, [this](){ if (m_chkFlipHor2) m_chkFlipHor2->setChecked(!m_chkFlipHor2->isChecked()); }, {}},
-        {"cmd_flip_v2", "Toggle Flip Vertical (Cam2)", "Capture", CmdType::Toggle, [this](){ if (m_chkFlipVer2) m_chkFlipVer2->setChecked(!m_chkFlipVer2->isChecked()); }, {}},
+        {"cmd_flip_h2", "Toggle Flip Horizontal (Compared Camera)", "Capture", CmdType::Toggle, [this](){ if (m_chkFlipHor2) m_chkFlipHor2->setChecked(!m_chkFlipHor2->isChecked()); }, {}},
+        {"cmd_flip_v2", "Toggle Flip Vertical (Compared Camera)", "Capture", CmdType::Toggle, [this](){ if (m_chkFlipVer2) m_chkFlipVer2->setChecked(!m_chkFlipVer2->isChecked()); }, {}},
 
         {"cmd_exposure_toggle", "Toggle Auto / Manual Exposure", "Exposure", CmdType::Toggle, [this](){ if (m_btnExpToggle) m_btnExpToggle->setChecked(!m_btnExpToggle->isChecked()); }, {}},
         {"cmd_gain_inc", "Gain +0.1x", "Exposure", CmdType::Action, [this](){
@@ -5021,7 +6594,11 @@ void MainWindow::initCommands()
         {"cmd_bilateral", "Toggle Bilateral Filter", "Pipeline", CmdType::Toggle, [this](){ if (m_chkBilateral) m_chkBilateral->setChecked(!m_chkBilateral->isChecked()); }, {}},
         {"cmd_stretch", "Toggle Intensity Stretch", "Pipeline", CmdType::Toggle, [this](){ if (m_chkStretch) m_chkStretch->setChecked(!m_chkStretch->isChecked()); }, {}},
         {"cmd_peaks", "Toggle Tracking Peaks", "Pipeline", CmdType::Toggle, [this](){ if (m_btnPeakIntensities) m_btnPeakIntensities->setChecked(!m_btnPeakIntensities->isChecked()); }, {}},
+        {"cmd_track_align", "Toggle Alignment Drift Tracking", "Pipeline", CmdType::Toggle, [this](){ if (m_chkTrackAlign) m_chkTrackAlign->setChecked(!m_chkTrackAlign->isChecked()); }, {}},
+        {"cmd_shift_align", "Toggle Shift-Only Alignment", "Pipeline", CmdType::Toggle, [this](){ if (m_chkShiftAlign) m_chkShiftAlign->setChecked(!m_chkShiftAlign->isChecked()); }, {}},
         {"cmd_calibrate", "Calibrate Alignment", "Pipeline", CmdType::Action, [this](){ calibrateAlignment(); }, {}},
+        {"cmd_undistort", "Toggle Lens Undistortion", "Pipeline", CmdType::Toggle, [this](){ if (m_chkUndistort) m_chkUndistort->setChecked(!m_chkUndistort->isChecked()); }, {}},
+        {"cmd_lens_capture", "Capture Lens Target", "Pipeline", CmdType::Action, [this](){ captureLensTarget(); }, {}},
         {"cmd_open_align", "Open Manual Align Dialog", "Pipeline", CmdType::Action, [this](){ if (m_btnOpenManualAlign) m_btnOpenManualAlign->click(); }, {}},
 
         {"cmd_tbuffer", "Time Buffer Size", "Pipeline Parameters", CmdType::Parameter, {}, [this, createPopup](QWidget*){ createPopup("Time Buffer Size", m_bufferSlider); }},
@@ -10,11 +10,28 @@
 #include <opencv2/core.hpp>
 #include <opencv2/videoio.hpp>
 #include <opencv2/imgproc.hpp>
-#include <opencv2/video/background_segm.hpp>
 
 #include "exif_writer.h"
-
+#include "frame_sync.h"
+#include "frame_mailbox.h"
+#include "stage_pool.h"
+#include "stage_meter.h"
+#include "lens_calibration.h"
+#include "align_tracking.h"
+#include "temporal_denoise.h"
+#include "temporal_stack.h"
+#include "motion_detector.h"
+#include "focus_metrics.h"
+#include "feature_align.h"
+#include "frame_source.h"
+#include "camera_discovery.h"
+#include "pixel_depth.h"
+
+#include <array>
+#include <condition_variable>
 #include <deque>
+#include <mutex>
+#include <vector>
 #include <thread>
 #include <atomic>
 #include <QString>
@@ -109,15 +126,89 @@ struct ManualAdjust {
     }
 };
 
+/* Camera 0 is the reference every other camera is aligned and compared to. */
+constexpr int kMaxCameras = 4;
+
+struct CameraFlip {
+    bool hor = false;
+    bool ver = false;
+};
+
 struct WorkerParams {
     ColorMode colorMode = ColorMode::GRAY_CV;
-    bool flipHor2 = false;
-    bool flipVer2 = false;
+    std::vector<CameraFlip> flips;
     double motionThr = 0.05;
+    MotionModel motionModel = MotionModel::RunningAverage;
     int bufferSize = 8;
+    TemporalMode temporalMode = TemporalMode::Ema;
     bool applyBilateral = false;
     int bilateralStrength = 5;
     int noiseFloor = 15;
+    PairingPolicy pairingPolicy = PairingPolicy::Nearest;
+    int maxSkewMs = 8;
+    /* Tiles of the per-camera focus map; empty while the map is off. */
+    cv::Size focusGrid;
+};
+
+/* Everything known about one processed pair, fixed when the worker
+   publishes it. Shared read-only between the mailbox, the GUI and any
+   snapshot written from the pair, so metadata always describes exactly
+   those pixels. */
+struct CameraMeta {
+    int64_t timestampNs = 0;
+    int64_t seq = 0;
+    uint32_t exposureGen = 0;
+    ExposureSettings exposure;
+    double focus = 0.0;
+    double tenengrad = 0.0;
+    double brenner = 0.0;
+    cv::Mat focusMap;
+    double motion = 0.0;
+    std::vector<cv::Rect> motionRegions;
+    /* Significant bits of the processed frame. */
+    int bits = 8;
+};
+
+struct FrameMeta {
+    std::vector<CameraMeta> cams;
+    bool live = false;
+    WorkerParams params;
+    bool motion = false;
+    qint64 frameCount = 0;
+    double skewMs = 0.0;
+    int64_t droppedFrames = 0;
+};
+
+/* GUI-side state a pair was rendered with (alignment, view options). */
+struct ViewMeta {
+    bool alignEnabled = false;
+    bool calibrated = false;
+    int activeAdjCam = 0;
+    int compareCam = 1;
+    std::vector<ManualAdjust> manual;
+    bool fusion = false;
+    bool undistort = false;
+    bool stretch = false;
+    bool trackPeaks = false;
+    bool motionActive = false;
+    bool diffMode = false;
+    /* Translation-only alignment, measured every shiftEvery frames. The
+       composer fills in the shift it applied to the compared camera, its
+       peak response and whether it fell back to the homography. */
+    bool shiftAlign = false;
+    int shiftEvery = 1;
+    cv::Point2d shift;
+    double shiftResponse = 0.0;
+    bool shiftFallback = false;
+    bool focusMap = false;
+    /* Calibration homographies per camera as eased for this pair (CV_32F,
+       camera -> reference pixels); empty for uncalibrated cameras. */
+    std::vector<cv::Mat> eccWarps;
+};
+
+struct FramePacket {
+    std::vector<cv::Mat> frames;
+    std::shared_ptr<const FrameMeta> meta;
 };
 
 class CameraWorker : public QThread {
@@ -126,38 +217,157 @@ public:
     CameraWorker(QObject* parent = nullptr);
     ~CameraWorker();
 
-    void startCameras(const std::string& pipe1, const std::string& pipe2, int w, int h, int fps);
-    void startCamerasV4L2(int id1, int id2, int w, int h, int fps);
+    void startCameras(const std::vector<std::string>& pipes, int fps);
+    void startCamerasV4L2(const QList<int>& ids, int w, int h, int fps, bool highBitDepth = false);
+    bool startCamerasNative(const std::vector<std::string>& pipes, int fps);
+    void startSources(std::vector<std::unique_ptr<FrameSource>> sources, int fps = 0);
     void stopCameras();
     void setParams(const WorkerParams& p);
+    uint32_t applyExposure(const std::vector<ExposureSettings>& e);
+    void resetExposure(const std::vector<ExposureSettings>& e);
+    bool takeLatest(FramePacket& out);
+    StageMeter& meter() { return m_meter; }
+    double queueFill() const { return m_sync.fill(); }
+    int64_t temporalBytes() const { return m_temporalBytes; }
 
 signals:
-    void framesProcessed(cv::Mat f1, cv::Mat f2, double focus1, double focus2, bool motion, qint64 frameCount);
+    void framesReady();
     void cameraError(QString msg);
+    void cameraStalled(int cam, bool stalled);
 
 protected:
     void run() override;
 
 private:
-    cv::Mat applyTemporalDenoise(cv::Mat& frame, cv::Mat& ema, int bufferSize);
-    double detectMotion(const cv::Mat& frame, double thr);
-    double calculateFocus(const cv::Mat& frame);
+    struct CameraState {
+        TemporalEmaState ema;
+        TemporalStack stack;
+        MotionDetector motion;
+        uint32_t exposureGen = 0;
+    };
+
+    cv::Mat applyTemporalDenoise(cv::Mat& frame, TemporalEmaState& state, int bufferSize);
     cv::Mat toWorkingFormat(const cv::Mat& frame, ColorMode mode);
+    void captureLoop(int cam);
+    bool pauseCapture(int ms);
 
-    cv::VideoCapture m_cap1;
-    cv::VideoCapture m_cap2;
+    std::vector<std::unique_ptr<FrameSource>> m_sources;
+    std::atomic<bool> m_captureColor{false};
     std::atomic<bool> m_running{false};
+    int64_t m_frameIntervalNs = 0;
+    std::vector<std::thread> m_grabThreads;
+    FrameSync m_sync;
 
     QMutex m_paramMutex;
     WorkerParams m_params;
 
-    cv::Ptr<cv::BackgroundSubtractorMOG2> m_bgSubtractor;
-    cv::Mat m_ema1;
-    cv::Mat m_ema2;
+    std::vector<CameraState> m_camState;
+    std::atomic<int64_t> m_temporalBytes{0};
+    StagePool m_stages;
     qint64 m_frameCount = 0;
+    static constexpr size_t kExposureHistory = 32;
+    uint32_t m_exposureGen = 0;
+    std::deque<std::pair<uint32_t, std::vector<ExposureSettings>>> m_exposureHistory;
+
+    StageMeter m_meter;
+
+    FrameMailbox<FramePacket> m_mailbox;
+    std::atomic<bool> m_notifyPending{false};
+};
 
+/* Everything the view composition reads, captured on the GUI thread so the
+   composition itself can run on ViewComposer. */
+struct ComposeJob {
+    std::vector<cv::Mat> frames;
+    std::shared_ptr<const FrameMeta> meta;
+    ViewMeta view;
+    /* Per camera, only filled while undistortion is on. lensGen changes
+       with every new lens model and keys the remap tables. */
+    std::vector<LensModel> lenses;
+    uint64_t lensGen = 0;
+    std::vector<double> focus;
+    int noiseFloor = 0;
+    QSize view1Size;
+    QSize view2Size;
+    QSize resultSize;
+};
+
+/* One composed view, ready to present: images are already scaled and
+   converted for their views; diff keeps the full-size colour map for
+   snapshots. */
+struct ComposedView {
+    bool diffMode = false;
+    QImage image1;
+    QImage image2;
+    QImage diffImage;
+    cv::Mat diff;
+    bool showPeaks = false;
+    double peak1 = 0.0;
+    double peak2 = 0.0;
+    int compareCam = 1;
+    double focus1 = 0.0;
+    double focus2 = 0.0;
+    std::shared_ptr<const FrameMeta> meta;
+    ViewMeta view;
+};
+
+/* Compose stage: capture threads -> CameraWorker (condition) ->
+   ViewComposer (warp, fusion, peaks, diff, colour map, scaling) -> GUI
+   (present). The input is a single slot; a job submitted while another
+   waits replaces it, so the queue is bounded and never adds latency. */
+class ViewComposer : public QThread {
+    Q_OBJECT
 public:
-    std::atomic<int> m_pendingFrames{0};
+    ViewComposer(QObject* parent = nullptr);
+    ~ViewComposer();
+
+    void submit(ComposeJob job);
+    bool takeLatest(ComposedView& out);
+    StageMeter& meter() { return m_meter; }
+    int64_t replacedJobs() const { return m_replaced; }
+
+signals:
+    void composed();
+
+protected:
+    void run() override;
+
+private:
+    struct RemapCache {
+        cv::Matx33d H;
+        cv::Size srcSize;
+        cv::Size dstSize;
+        uint64_t lensGen = 0;
+        cv::Mat map1;
+        cv::Mat map2;
+    };
+
+    struct ShiftState {
+        bool valid = false;
+        cv::Point2d shift;
+        double response = 0.0;
+        int age = 0;
+        cv::Size size;
+        cv::Mat window;
+    };
+
+    ComposedView compose(const ComposeJob& job);
+    cv::Mat resample(int slot, const cv::Mat& src, const cv::Matx33d& H, const cv::Size& dstSize,
+                     const LensModel& lens, uint64_t lensGen);
+    bool trackShift(int c, const cv::Mat& ref, const cv::Mat& cam, int every, cv::Point2d& shift, double& response);
+
+    std::mutex m_jobMutex;
+    std::condition_variable m_jobCv;
+    ComposeJob m_job;
+    bool m_hasJob = false;
+    bool m_stop = false;
+    std::atomic<int64_t> m_replaced{0};
+    StageMeter m_meter;
+    std::vector<RemapCache> m_remaps;
+    std::vector<ShiftState> m_shifts;
+
+    FrameMailbox<ComposedView> m_mailbox;
+    std::atomic<bool> m_notifyPending{false};
 };
 
 class MainWindow : public QMainWindow
@@ -174,6 +384,7 @@ public:
     void showActionsMenu();
     void applyShortcut(const QString& id, const QKeySequence& seq);
     void executeCommand(const QString& id);
+    void setSourceSpec(const SourceSpec& spec);
 
     QList<AppCommand> m_commands;
     QMap<QString, QShortcut*> m_shortcuts;
@@ -191,12 +402,15 @@ private slots:
     void closeCameras();
     void updateView();
     void calibrateAlignment();
+    void captureLensTarget();
+    void resetLensCalibration();
     void saveSnapshot();
     void toggleSheet();
     void setDiffMode(bool on);
 
 public slots:
-    void onFramesProcessed(cv::Mat f1, cv::Mat f2, double focus1, double focus2, bool motionDetected, qint64 frameCount);
+    void onFramesProcessed();
+    void onViewComposed();
 
 private:
     void initUI();
@@ -236,17 +450,17 @@ private:
     void saveDiffSnapshot();
     void saveDualSnapshot(bool combined);
     QString buildSnapshotBaseName(const QString& prefix) const;
-    ExifParams buildExifParams(const QString& mode) const;
+    ViewMeta currentViewMeta() const;
+    ExifParams buildExifParams(const QString& mode, const FrameMeta* meta, const ViewMeta& view) const;
 
     void displayMat(GpuImageView* view, const cv::Mat& mat);
-    double calculateFocus(const cv::Mat& frame);
     void pushWorkerParams();
 
-    cv::Mat fuseCameras(const cv::Mat& a, const cv::Mat& b);
-    cv::Mat applyDiffView(const cv::Mat& d1, const cv::Mat& d2);
 
-    QStringList getLibCameraIds();
-    std::string makeGStreamerPipeline(const QString& cameraId, int width, int height, int fps, int camIndex = 0);
+    bool startOfflineSources(int width, int height);
+    ExposureSettings exposureFor(int camIndex) const;
+    std::vector<ExposureSettings> exposures() const;
+    std::string makeGStreamerPipeline(const QString& cameraId, int width, int height, int fps, int camIndex = 0, bool native = false);
     void applyExposureControls();
 
     void saveSettings();
@@ -257,18 +471,66 @@ private:
     void refreshPresetList();
     void refreshCameraModes();
 
-    cv::Mat buildManualHomography(const ManualAdjust& a, const cv::Size& sz) const;
+    bool undistortActive(int cam) const;
+    void undistortChanged();
+    void updateLensIndicator();
+    void invalidateAlignment(const QString& reason);
+    void trackAlignment();
+    void easeAlignment();
+    void startAlignRefinement(std::function<void(const std::vector<AlignRefinement>&, const cv::Size&)> done);
+    QString alignCacheKey() const;
+    bool loadCachedAlignment();
+    void saveCachedAlignment(const std::vector<AlignEstimate>& estimates);
+    void validateCachedAlignment();
+    double focusOf(int cam) const;
+    void setCameraCount(int count);
+    void setCompareCam(int cam);
     ManualAdjust& activeManualAdjust();
     void applyAdjustToWidgets();
     void applyWidgetsToAdjust();
     void resetActiveAdjust();
 
     CameraWorker* m_worker = nullptr;
-
-    cv::Mat m_frame1;
-    cv::Mat m_frame2;
-    cv::Mat m_eccWarpMatrix;
+    ViewComposer* m_composer = nullptr;
+    StageMeter m_presentMeter;
+    int64_t m_stageSampleNs = 0;
+    void updateStageStats();
+    CameraDiscovery* m_discovery = nullptr;
+    bool m_openWhenDiscovered = false;
+    SourceSpec m_sourceSpec;
+
+    int m_cameraCount = 2;
+    int m_compareCam = 1;
+    std::vector<cv::Mat> m_frames;
+    std::vector<cv::Mat> m_eccWarps;
+    /* Background tracking: the matrices of the last full calibration, the
+       latest refined estimate m_eccWarps eases towards, and a generation
+       that discards estimates started before a recalibration. */
+    std::vector<cv::Mat> m_alignBaseline;
+    std::vector<cv::Mat> m_alignTarget;
+    uint64_t m_alignGen = 0;
+    double m_alignDrift = 0.0;
+    /* Last translation the composer applied in shift mode. */
+    cv::Point2d m_phaseShift;
+    double m_phaseResponse = 0.0;
+    bool m_phaseFallback = true;
+    int64_t m_trackStartNs = 0;
+    int64_t m_trackStepNs = 0;
+    /* Identity of the open session for the calibration cache, and whether
+       a cached matrix still waits for its check against live frames. */
+    QStringList m_sessionCamIds;
+    QSize m_sessionSize;
+    bool m_validateAlign = false;
+    /* Lens models and the chessboard views collected towards them. */
+    std::array<LensModel, kMaxCameras> m_lens;
+    std::array<std::vector<std::vector<cv::Point2f>>, kMaxCameras> m_lensViews;
+    uint64_t m_lensGen = 1;
     cv::Mat m_lastDiffResult;
+    std::shared_ptr<const FrameMeta> m_frameMeta;
+    /* View settings m_frames were last composed with. */
+    ViewMeta m_frameView;
+    std::shared_ptr<const FrameMeta> m_lastDiffMeta;
+    ViewMeta m_lastDiffView;
 
     bool m_camerasOpen = false;
     bool m_isAligned = false;
@@ -281,8 +543,10 @@ private:
     qint64 m_frameCount = 0;
     int m_maxHistory = 200;
 
-    double m_lastFocus1 = 0.0;
-    double m_lastFocus2 = 0.0;
+    std::vector<double> m_lastFocus;
+    double m_lastSkewMs = 0.0;
+    int64_t m_droppedFrames = 0;
+    std::array<bool, kMaxCameras> m_camStalled{};
 
     int m_bufferSize = 8;
     double m_motionThreshold = 0.05;
@@ -292,8 +556,8 @@ private:
 
     ColorMode m_colorMode = ColorMode::GRAY_CV;
 
-    ManualAdjust m_manualAdj1;
-    ManualAdjust m_manualAdj2;
+    std::array<ManualAdjust, kMaxCameras> m_manualAdj;
+    std::array<CameraFlip, kMaxCameras> m_flips;
     int m_activeAdjCam = 2;
     bool m_updatingAdjUI = false;
 
@@ -336,6 +600,7 @@ private:
     int m_shutterUs = 10000;
     int m_gain2Q8 = 256;
     int m_shutter2Us = 10000;
+    uint32_t m_pendingExposureGen = 0;
     void showExposureDialog();
 
     QPushButton* m_btnConfigParams = nullptr;
@@ -356,8 +621,18 @@ private:
 
     QPushButton* m_btnToggleCameras;
     QComboBox* m_comboColorMode;
-    QCheckBox* m_chkFlipVer2;
-    QCheckBox* m_chkFlipHor2;
+    QComboBox* m_comboPairing = nullptr;
+    QComboBox* m_comboTemporal = nullptr;
+    QComboBox* m_comboMotionModel = nullptr;
+    QSpinBox* m_spnMaxSkew = nullptr;
+    QComboBox* m_comboSource = nullptr;
+    QCheckBox* m_chkHighBitDepth = nullptr;
+    QSpinBox* m_spnReplayFps = nullptr;
+    QSpinBox* m_spnCameraCount = nullptr;
+    QComboBox* m_comboCompareCam = nullptr;
+    QLabel* m_lblFlipSection = nullptr;
+    QCheckBox* m_chkFlipVer2 = nullptr;
+    QCheckBox* m_chkFlipHor2 = nullptr;
     QCheckBox* m_chkStretchView;
     QCheckBox* m_chkBilateral;
     QSlider* m_bilateralSlider;
@@ -375,6 +650,13 @@ private:
     QPushButton* m_btnCalibrateAlign;
     QLabel* m_eccIndicator;
     QPushButton* m_btnOpenManualAlign;
+    QCheckBox* m_chkTrackAlign = nullptr;
+    QCheckBox* m_chkShiftAlign = nullptr;
+    QSpinBox* m_spnShiftEvery = nullptr;
+    QCheckBox* m_chkUndistort = nullptr;
+    QPushButton* m_btnLensCapture = nullptr;
+    QPushButton* m_btnLensReset = nullptr;
+    QLabel* m_lensIndicator = nullptr;
 
     QSlider* m_noiseFloorSlider;
     QLabel* m_noiseFloorLabel;
@@ -384,12 +666,14 @@ private:
 
     QLabel* m_lblFocus1Big;
     QLabel* m_lblFocus2Big;
+    QLabel* m_lblFocus1Detail = nullptr;
+    QLabel* m_lblFocus2Detail = nullptr;
+    QCheckBox* m_chkFocusMap = nullptr;
     QSpinBox* m_historySpinBox;
     QSlider* m_historySlider;
     QChartView* m_chartView;
     QChart* m_chart;
-    QLineSeries* m_seriesCam1;
-    QLineSeries* m_seriesCam2;
+    QList<QLineSeries*> m_seriesCam;
 
     QWidget* m_focusDataWidget;
     QListWidget* m_snapshotPreview = nullptr;
@@ -402,7 +686,7 @@ private:
     QPushButton* m_btnDeletePreset;
 
     QDialog* m_alignDialog;
-    QComboBox* m_comboAdjCam;
+    QComboBox* m_comboAdjCam = nullptr;
     QSlider* m_sldAdjTx; QDoubleSpinBox* m_spnAdjTx;
     QSlider* m_sldAdjTy; QDoubleSpinBox* m_spnAdjTy;
     QSlider* m_sldAdjScale; QDoubleSpinBox* m_spnAdjScale;
@@ -422,6 +706,10 @@ private:
 
     std::thread m_calibThread;
     std::atomic<bool> m_calibrating{false};
+    /* Outlives single calibrations so the losing detector stays owned. */
+    FeatureAligner m_aligner;
+    std::thread m_trackThread;
+    bool m_trackBusy = false;
 };
 
 #endif
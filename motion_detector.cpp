@@ -0,0 +1,95 @@
+#include "motion_detector.h"
+#include "pixel_depth.h"
+
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+
+namespace {
+    /* Difference from the background, in 8-bit levels, that counts as
+       motion after the 3x3 blur; well above sensor noise at the working
+       level, where every pixel already averages 16 or 64 sensor pixels. */
+    constexpr double kDiffThreshold = 12.0;
+    /* Background learning rate: a stopped object becomes background after
+       roughly 1 / kLearnRate frames. */
+    constexpr double kLearnRate = 0.05;
+    constexpr double kMog2LearnRate = 0.01;
+    /* Regions smaller than this at the working level are noise. */
+    constexpr int kMinRegionArea = 4;
+    constexpr int kMaxRegions = 16;
+
+    int shrinkFactor(const cv::Size& size)
+    {
+        return size.width > 1280 ? 8 : 4;
+    }
+
+    /* Downscale first, so colour conversion and depth reduction only touch
+       the small image. */
+    cv::Mat workingLevel(const cv::Mat& frame, int factor)
+    {
+        cv::Mat small, gray;
+        cv::resize(frame, small, cv::Size(std::max(1, frame.cols / factor), std::max(1, frame.rows / factor)),
+                   0, 0, cv::INTER_AREA);
+        if (small.channels() == 3) cv::cvtColor(small, gray, cv::COLOR_BGR2GRAY);
+        else gray = small;
+        return toDisplay8(gray);
+    }
+}
+
+void MotionDetector::reset()
+{
+    m_background.release();
+    m_mog2.release();
+}
+
+MotionResult MotionDetector::detect(const cv::Mat& frame, MotionModel model)
+{
+    MotionResult res;
+    if (frame.empty()) return res;
+    if (model != m_model) {
+        reset();
+        m_model = model;
+    }
+
+    const int factor = shrinkFactor(frame.size());
+    cv::Mat small = workingLevel(frame, factor);
+
+    cv::Mat mask;
+    if (model == MotionModel::Mog2) {
+        if (!m_mog2) m_mog2 = cv::createBackgroundSubtractorMOG2(500, 16.0, false);
+        m_mog2->apply(small, mask, kMog2LearnRate);
+    } else {
+        cv::GaussianBlur(small, small, cv::Size(3, 3), 0);
+        if (m_background.size() != small.size()) {
+            small.convertTo(m_background, CV_32F);
+            return res;
+        }
+        cv::Mat background8, diff;
+        m_background.convertTo(background8, CV_8U);
+        cv::absdiff(small, background8, diff);
+        cv::threshold(diff, mask, kDiffThreshold, 255, cv::THRESH_BINARY);
+        cv::accumulateWeighted(small, m_background, kLearnRate);
+    }
+
+    /* Opening drops isolated pixels, the dilation joins the parts of one
+       object before they are boxed. */
+    const cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(3, 3));
+    cv::morphologyEx(mask, mask, cv::MORPH_OPEN, kernel);
+    res.ratio = static_cast<double>(cv::countNonZero(mask)) / mask.total();
+    if (res.ratio <= 0.0) return res;
+    cv::dilate(mask, mask, kernel, cv::Point(-1, -1), 2);
+
+    cv::Mat labels, stats, centroids;
+    const int count = cv::connectedComponentsWithStats(mask, labels, stats, centroids, 8, CV_32S);
+    const cv::Rect bounds(0, 0, frame.cols, frame.rows);
+    for (int i = 1; i < count; ++i) {
+        if (stats.at<int>(i, cv::CC_STAT_AREA) < kMinRegionArea) continue;
+        const cv::Rect r(stats.at<int>(i, cv::CC_STAT_LEFT) * factor, stats.at<int>(i, cv::CC_STAT_TOP) * factor,
+                         stats.at<int>(i, cv::CC_STAT_WIDTH) * factor, stats.at<int>(i, cv::CC_STAT_HEIGHT) * factor);
+        res.regions.push_back(r & bounds);
+    }
+    std::sort(res.regions.begin(), res.regions.end(),
+              [](const cv::Rect& a, const cv::Rect& b) { return a.area() > b.area(); });
+    if (static_cast<int>(res.regions.size()) > kMaxRegions) res.regions.resize(kMaxRegions);
+    return res;
+}
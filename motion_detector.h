@@ -0,0 +1,34 @@
+#ifndef MOTION_DETECTOR_H
+#define MOTION_DETECTOR_H
+
+#include <opencv2/core.hpp>
+#include <opencv2/video/background_segm.hpp>
+
+#include <vector>
+
+enum class MotionModel { RunningAverage, Mog2 };
+
+/* What one camera saw move in one frame. */
+struct MotionResult {
+    /* Moving fraction of the frame. */
+    double ratio = 0.0;
+    /* Moving regions in full-resolution pixels, largest first. */
+    std::vector<cv::Rect> regions;
+};
+
+/* Per-camera motion engine. Works on a 1/4 pyramid level (1/8 above
+   1280 px wide) converted to 8-bit gray. The default model is a running
+   average background with a frame difference against it; MOG2 is kept as
+   an option for scenes with repetitive background motion. */
+class MotionDetector {
+public:
+    MotionResult detect(const cv::Mat& frame, MotionModel model);
+    void reset();
+
+private:
+    cv::Mat m_background;
+    cv::Ptr<cv::BackgroundSubtractorMOG2> m_mog2;
+    MotionModel m_model = MotionModel::RunningAverage;
+};
+
+#endif // MOTION_DETECTOR_H
@@ -0,0 +1,26 @@
+#ifndef PIXEL_DEPTH_H
+#define PIXEL_DEPTH_H
+
+#include <opencv2/core.hpp>
+
+/* Frames travel through the pipeline as CV_8U or CV_16U. 16-bit frames are
+   MSB-aligned: 10/12-bit sensor codes are shifted up so full scale is always
+   65535 and one 8-bit step is kStep16 counts. Thresholds and sigmas kept in
+   8-bit units (noise floor, bilateral strength, overlay colours) are
+   multiplied by pixelScale() so they mean the same at either depth. */
+constexpr double kStep16 = 65535.0 / 255.0;
+
+inline double pixelScale(int depth) { return depth == CV_16U ? kStep16 : 1.0; }
+inline double pixelMax(int depth) { return depth == CV_16U ? 65535.0 : 255.0; }
+inline int pixelBits(int depth) { return depth == CV_16U ? 16 : 8; }
+
+/* The one place 16-bit data is tone-mapped (linearly) down to 8 bits. */
+inline cv::Mat toDisplay8(const cv::Mat& m)
+{
+    if (m.empty() || m.depth() == CV_8U) return m;
+    cv::Mat out;
+    m.convertTo(out, CV_8U, 255.0 / pixelMax(m.depth()));
+    return out;
+}
+
+#endif // PIXEL_DEPTH_H
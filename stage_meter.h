@@ -0,0 +1,56 @@
+#ifndef STAGE_METER_H
+#define STAGE_METER_H
+
+#include "frame_sync.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+/* Occupancy of one pipeline stage: the share of wall time the stage spent
+   working since the previous sample(). A stage close to 100% is the one
+   limiting throughput. The stage thread records through Scope, any other
+   thread samples; both sides only touch atomics. */
+class StageMeter {
+public:
+    class Scope {
+    public:
+        explicit Scope(StageMeter& meter) : m_meter(meter), m_startNs(monotonicNowNs()) {}
+        ~Scope() { m_meter.add(monotonicNowNs() - m_startNs); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        StageMeter& m_meter;
+        int64_t m_startNs;
+    };
+
+    struct Sample {
+        double occupancy = 0.0;
+        int64_t items = 0;
+    };
+
+    void add(int64_t busyNs)
+    {
+        m_busyNs.fetch_add(busyNs, std::memory_order_relaxed);
+        m_items.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Sample sample()
+    {
+        const int64_t now = monotonicNowNs();
+        const int64_t window = now - m_windowStartNs.exchange(now, std::memory_order_relaxed);
+        Sample s;
+        const int64_t busy = m_busyNs.exchange(0, std::memory_order_relaxed);
+        s.items = m_items.exchange(0, std::memory_order_relaxed);
+        if (window > 0) s.occupancy = std::min(1.0, static_cast<double>(busy) / static_cast<double>(window));
+        return s;
+    }
+
+private:
+    std::atomic<int64_t> m_busyNs{0};
+    std::atomic<int64_t> m_items{0};
+    std::atomic<int64_t> m_windowStartNs{monotonicNowNs()};
+};
+
+#endif // STAGE_METER_H
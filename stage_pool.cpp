@@ -0,0 +1,81 @@
+#include "stage_pool.h"
+
+#include <algorithm>
+
+StagePool::~StagePool()
+{
+    resize(0);
+}
+
+void StagePool::resize(int n)
+{
+    const size_t workers = static_cast<size_t>(std::max(n - 1, 0));
+    if (workers == m_threads.size()) return;
+
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_stop = true;
+    }
+    m_start.notify_all();
+    for (std::thread& t : m_threads) t.join();
+    m_threads.clear();
+
+    m_stop = false;
+    for (size_t i = 0; i < workers; ++i)
+        m_threads.emplace_back(&StagePool::workerLoop, this, static_cast<int>(i) + 1, m_generation);
+}
+
+void StagePool::run(int n, const std::function<void(int)>& fn)
+{
+    if (n <= 0) return;
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_job = &fn;
+        m_items = std::min(n, static_cast<int>(m_threads.size()) + 1);
+        m_pending = m_items - 1;
+        m_error = nullptr;
+        ++m_generation;
+    }
+    m_start.notify_all();
+
+    /* The caller takes index 0 and anything the pool has no worker for. */
+    std::exception_ptr error;
+    try {
+        fn(0);
+        for (int i = m_items; i < n; ++i) fn(i);
+    }
+    catch (...) {
+        error = std::current_exception();
+    }
+
+    std::unique_lock<std::mutex> lk(m_mutex);
+    m_done.wait(lk, [this]() { return m_pending == 0; });
+    m_job = nullptr;
+    if (!error) error = m_error;
+    lk.unlock();
+    if (error) std::rethrow_exception(error);
+}
+
+void StagePool::workerLoop(int index, uint64_t generation)
+{
+    std::unique_lock<std::mutex> lk(m_mutex);
+    for (;;) {
+        m_start.wait(lk, [&]() { return m_stop || m_generation != generation; });
+        if (m_stop) return;
+        generation = m_generation;
+        if (index >= m_items) continue;
+
+        const std::function<void(int)>* job = m_job;
+        lk.unlock();
+        std::exception_ptr error;
+        try {
+            (*job)(index);
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+        lk.lock();
+        if (error && !m_error) m_error = error;
+        if (--m_pending == 0) m_done.notify_one();
+    }
+}
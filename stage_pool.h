@@ -0,0 +1,44 @@
+#ifndef STAGE_POOL_H
+#define STAGE_POOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Persistent per-camera workers for the processing stages of a frame set.
+   run(n, fn) calls fn(i) for every i in [0, n) — index 0 on the calling
+   thread, index i on worker i — and returns once all of them finished.
+   OpenCV runs parallel_for_ regions started from several of these threads
+   at once one after another, so fn keeps its own loops on its thread. An
+   exception thrown by any fn(i) is rethrown from run() after the join. */
+class StagePool {
+public:
+    StagePool() = default;
+    ~StagePool();
+    StagePool(const StagePool&) = delete;
+    StagePool& operator=(const StagePool&) = delete;
+
+    /* Keeps n - 1 workers alive. Must not overlap with run(). */
+    void resize(int n);
+    void run(int n, const std::function<void(int)>& fn);
+
+private:
+    void workerLoop(int index, uint64_t generation);
+
+    std::mutex m_mutex;
+    std::condition_variable m_start;
+    std::condition_variable m_done;
+    std::vector<std::thread> m_threads;
+    const std::function<void(int)>* m_job = nullptr;
+    uint64_t m_generation = 0;
+    int m_items = 0;
+    int m_pending = 0;
+    bool m_stop = false;
+    std::exception_ptr m_error;
+};
+
+#endif // STAGE_POOL_H
@@ -0,0 +1,359 @@
+#include "temporal_denoise.h"
+#include "temporal_denoise_detail.h"
+
+#include <opencv2/core/utility.hpp>
+
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define DUALCAM_EMA_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define DUALCAM_EMA_NEON 1
+#include <arm_neon.h>
+#endif
+
+/* GCC and Clang need the ISA enabled per function to emit it without
+   raising the baseline of the whole build; MSVC always accepts it. */
+#if defined(__GNUC__) || defined(__clang__)
+#define DUALCAM_EMA_TARGET(isa) __attribute__((target(isa)))
+#else
+#define DUALCAM_EMA_TARGET(isa)
+#endif
+
+namespace {
+    using namespace ema_detail;
+
+    /* Noise model, in accumulator units (128 per 8-bit level). Samples more
+       than kNoiseSigmas from their history count as motion. The estimate
+       starts at two levels and follows the mean absolute difference of the
+       static samples; for a normal distribution truncated at 3 sigma that
+       mean is kTruncatedMean sigma. */
+    constexpr double kNoiseSigmas = 3.0;
+    constexpr double kTruncatedMean = 0.79;
+    constexpr double kInitialNoise = 256.0;
+    constexpr double kMinNoise = 64.0;
+    constexpr double kNoiseSmoothing = 0.1;
+    /* Keeps the 32-bit SIMD sums of one kernel call from overflowing. */
+    constexpr int kChunk = 1 << 16;
+
+    /* One update in Q15: acc += round((t - acc) * w / 2^15). This is what
+       _mm_mulhrs_epi16 and vqrdmulhq_s16 compute, so every path produces the
+       same bits. With w <= 32767 the step never overshoots t, and t - acc
+       always fits in 16 bits because t and acc stay within [0, 32767]. */
+    inline int16_t emaStep(int t, int acc, const EmaParams& p, EmaStats& s)
+    {
+        const int d = t - acc;
+        const int ad = d < 0 ? -d : d;
+        if (ad <= p.thr) {
+            s.sum += ad;
+            ++s.count;
+        }
+        const int w = p.a + std::min(std::max(ad - p.thr, 0), p.thr) * p.slope;
+        return static_cast<int16_t>(acc + ((d * w + 0x4000) >> 15));
+    }
+
+    /* 8-bit frames: t = x << 7, output (acc + 64) >> 7. */
+    void row8Scalar(const uint8_t* src, int16_t* acc, uint8_t* dst, int n, const EmaParams& p, EmaStats& s)
+    {
+        for (int i = 0; i < n; ++i) {
+            acc[i] = emaStep(src[i] << 7, acc[i], p, s);
+            dst[i] = static_cast<uint8_t>((acc[i] + 64) >> 7);
+        }
+    }
+
+    /* 16-bit frames: t = x >> 1, output replicates the top bit into bit 0 so
+       a saturated accumulator maps back to 65535. */
+    void row16Scalar(const uint16_t* src, int16_t* acc, uint16_t* dst, int n, const EmaParams& p, EmaStats& s)
+    {
+        for (int i = 0; i < n; ++i) {
+            acc[i] = emaStep(src[i] >> 1, acc[i], p, s);
+            dst[i] = static_cast<uint16_t>((acc[i] << 1) | (acc[i] >> 14));
+        }
+    }
+
+#ifdef DUALCAM_EMA_X86
+    struct Ssse3Step {
+        __m128i a, thr, slope, ones, sum, moving;
+
+        DUALCAM_EMA_TARGET("ssse3")
+        explicit Ssse3Step(const EmaParams& p)
+            : a(_mm_set1_epi16(static_cast<short>(p.a))), thr(_mm_set1_epi16(static_cast<short>(p.thr))),
+              slope(_mm_set1_epi16(static_cast<short>(p.slope))), ones(_mm_set1_epi16(1)),
+              sum(_mm_setzero_si128()), moving(_mm_setzero_si128()) {}
+
+        DUALCAM_EMA_TARGET("ssse3")
+        __m128i operator()(__m128i t, __m128i v)
+        {
+            const __m128i d = _mm_sub_epi16(t, v);
+            const __m128i ad = _mm_abs_epi16(d);
+            const __m128i ramp = _mm_min_epi16(_mm_subs_epu16(ad, thr), thr);
+            const __m128i w = _mm_add_epi16(a, _mm_mullo_epi16(ramp, slope));
+            const __m128i mask = _mm_cmpgt_epi16(ad, thr);
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_andnot_si128(mask, ad), ones));
+            moving = _mm_sub_epi32(moving, _mm_madd_epi16(mask, ones));
+            return _mm_add_epi16(v, _mm_mulhrs_epi16(d, w));
+        }
+
+        DUALCAM_EMA_TARGET("ssse3")
+        void finish(int processed, EmaStats& s) const
+        {
+            alignas(16) int32_t su[4], mo[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(su), sum);
+            _mm_store_si128(reinterpret_cast<__m128i*>(mo), moving);
+            s.sum += int64_t(su[0]) + su[1] + su[2] + su[3];
+            s.count += processed - (int64_t(mo[0]) + mo[1] + mo[2] + mo[3]);
+        }
+    };
+
+    DUALCAM_EMA_TARGET("ssse3")
+    void row8Ssse3(const uint8_t* src, int16_t* acc, uint8_t* dst, int n, const EmaParams& p, EmaStats& s)
+    {
+        Ssse3Step step(p);
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i half = _mm_set1_epi16(64);
+        int i = 0;
+        for (; i + 16 <= n; i += 16) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            const __m128i aLo = step(_mm_slli_epi16(_mm_unpacklo_epi8(x, zero), 7),
+                                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + i)));
+            const __m128i aHi = step(_mm_slli_epi16(_mm_unpackhi_epi8(x, zero), 7),
+                                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + i + 8)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + i), aLo);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + i + 8), aHi);
+            const __m128i out = _mm_packus_epi16(_mm_srli_epi16(_mm_add_epi16(aLo, half), 7),
+                                                 _mm_srli_epi16(_mm_add_epi16(aHi, half), 7));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), out);
+        }
+        step.finish(i, s);
+        row8Scalar(src + i, acc + i, dst + i, n - i, p, s);
+    }
+
+    DUALCAM_EMA_TARGET("ssse3")
+    void row16Ssse3(const uint16_t* src, int16_t* acc, uint16_t* dst, int n, const EmaParams& p, EmaStats& s)
+    {
+        Ssse3Step step(p);
+        int i = 0;
+        for (; i + 8 <= n; i += 8) {
+            const __m128i v = step(_mm_srli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), 1),
+                                   _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + i)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + i), v);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                             _mm_or_si128(_mm_slli_epi16(v, 1), _mm_srli_epi16(v, 14)));
+        }
+        step.finish(i, s);
+        row16Scalar(src + i, acc + i, dst + i, n - i, p, s);
+    }
+
+    struct Avx2Step {
+        __m256i a, thr, slope, ones, sum, moving;
+
+        DUALCAM_EMA_TARGET("avx2")
+        explicit Avx2Step(const EmaParams& p)
+            : a(_mm256_set1_epi16(static_cast<short>(p.a))), thr(_mm256_set1_epi16(static_cast<short>(p.thr))),
+              slope(_mm256_set1_epi16(static_cast<short>(p.slope))), ones(_mm256_set1_epi16(1)),
+              sum(_mm256_setzero_si256()), moving(_mm256_setzero_si256()) {}
+
+        DUALCAM_EMA_TARGET("avx2")
+        __m256i operator()(__m256i t, __m256i v)
+        {
+            const __m256i d = _mm256_sub_epi16(t, v);
+            const __m256i ad = _mm256_abs_epi16(d);
+            const __m256i ramp = _mm256_min_epi16(_mm256_subs_epu16(ad, thr), thr);
+            const __m256i w = _mm256_add_epi16(a, _mm256_mullo_epi16(ramp, slope));
+            const __m256i mask = _mm256_cmpgt_epi16(ad, thr);
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_andnot_si256(mask, ad), ones));
+            moving = _mm256_sub_epi32(moving, _mm256_madd_epi16(mask, ones));
+            return _mm256_add_epi16(v, _mm256_mulhrs_epi16(d, w));
+        }
+
+        DUALCAM_EMA_TARGET("avx2")
+        void finish(int processed, EmaStats& s) const
+        {
+            alignas(32) int32_t su[8], mo[8];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(su), sum);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(mo), moving);
+            int64_t movingCount = 0;
+            for (int k = 0; k < 8; ++k) {
+                s.sum += su[k];
+                movingCount += mo[k];
+            }
+            s.count += processed - movingCount;
+        }
+    };
+
+    DUALCAM_EMA_TARGET("avx2")
+    void row8Avx2(const uint8_t* src, int16_t* acc, uint8_t* dst, int n, const EmaParams& p, EmaStats& s)
+    {
+        Avx2Step step(p);
+        const __m256i half = _mm256_set1_epi16(64);
+        int i = 0;
+        for (; i + 32 <= n; i += 32) {
+            const __m256i aLo = step(
+                _mm256_slli_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))), 7),
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + i)));
+            const __m256i aHi = step(
+                _mm256_slli_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16))), 7),
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + i + 16)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc + i), aLo);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc + i + 16), aHi);
+            /* packus works per 128-bit lane; the permute restores pixel order. */
+            const __m256i packed = _mm256_packus_epi16(_mm256_srli_epi16(_mm256_add_epi16(aLo, half), 7),
+                                                       _mm256_srli_epi16(_mm256_add_epi16(aHi, half), 7));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_permute4x64_epi64(packed, 0xD8));
+        }
+        step.finish(i, s);
+        row8Ssse3(src + i, acc + i, dst + i, n - i, p, s);
+    }
+
+    DUALCAM_EMA_TARGET("avx2")
+    void row16Avx2(const uint16_t* src, int16_t* acc, uint16_t* dst, int n, const EmaParams& p, EmaStats& s)
+    {
+        Avx2Step step(p);
+        int i = 0;
+        for (; i + 16 <= n; i += 16) {
+            const __m256i v = step(_mm256_srli_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)), 1),
+                                   _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + i)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc + i), v);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                                _mm256_or_si256(_mm256_slli_epi16(v, 1), _mm256_srli_epi16(v, 14)));
+        }
+        step.finish(i, s);
+        row16Ssse3(src + i, acc + i, dst + i, n - i, p, s);
+    }
+#endif
+
+#ifdef DUALCAM_EMA_NEON
+    struct NeonStep {
+        int16x8_t a, thr, slope;
+        uint32x4_t sum, moving;
+
+        explicit NeonStep(const EmaParams& p)
+            : a(vdupq_n_s16(static_cast<int16_t>(p.a))), thr(vdupq_n_s16(static_cast<int16_t>(p.thr))),
+              slope(vdupq_n_s16(static_cast<int16_t>(p.slope))), sum(vdupq_n_u32(0)), moving(vdupq_n_u32(0)) {}
+
+        int16x8_t operator()(int16x8_t t, int16x8_t v)
+        {
+            const int16x8_t d = vsubq_s16(t, v);
+            const int16x8_t ad = vabsq_s16(d);
+            const uint16x8_t uad = vreinterpretq_u16_s16(ad);
+            const uint16x8_t uthr = vreinterpretq_u16_s16(thr);
+            const int16x8_t ramp = vreinterpretq_s16_u16(vminq_u16(vqsubq_u16(uad, uthr), uthr));
+            const int16x8_t w = vaddq_s16(a, vmulq_s16(ramp, slope));
+            const uint16x8_t mask = vcgtq_s16(ad, thr);
+            sum = vpadalq_u16(sum, vbicq_u16(uad, mask));
+            moving = vpadalq_u16(moving, vshrq_n_u16(mask, 15));
+            return vaddq_s16(v, vqrdmulhq_s16(d, w));
+        }
+
+        void finish(int processed, EmaStats& s) const
+        {
+            uint32_t su[4], mo[4];
+            vst1q_u32(su, sum);
+            vst1q_u32(mo, moving);
+            s.sum += int64_t(su[0]) + su[1] + su[2] + su[3];
+            s.count += processed - (int64_t(mo[0]) + mo[1] + mo[2] + mo[3]);
+        }
+    };
+
+    void row8Neon(const uint8_t* src, int16_t* acc, uint8_t* dst, int n, const EmaParams& p, EmaStats& s)
+    {
+        NeonStep step(p);
+        int i = 0;
+        for (; i + 16 <= n; i += 16) {
+            const uint8x16_t x = vld1q_u8(src + i);
+            const int16x8_t aLo = step(vreinterpretq_s16_u16(vshll_n_u8(vget_low_u8(x), 7)), vld1q_s16(acc + i));
+            const int16x8_t aHi = step(vreinterpretq_s16_u16(vshll_n_u8(vget_high_u8(x), 7)), vld1q_s16(acc + i + 8));
+            vst1q_s16(acc + i, aLo);
+            vst1q_s16(acc + i + 8, aHi);
+            vst1q_u8(dst + i, vcombine_u8(vqrshrun_n_s16(aLo, 7), vqrshrun_n_s16(aHi, 7)));
+        }
+        step.finish(i, s);
+        row8Scalar(src + i, acc + i, dst + i, n - i, p, s);
+    }
+
+    void row16Neon(const uint16_t* src, int16_t* acc, uint16_t* dst, int n, const EmaParams& p, EmaStats& s)
+    {
+        NeonStep step(p);
+        int i = 0;
+        for (; i + 8 <= n; i += 8) {
+            const int16x8_t v = step(vreinterpretq_s16_u16(vshrq_n_u16(vld1q_u16(src + i), 1)), vld1q_s16(acc + i));
+            vst1q_s16(acc + i, v);
+            const uint16x8_t u = vreinterpretq_u16_s16(v);
+            vst1q_u16(dst + i, vorrq_u16(vshlq_n_u16(u, 1), vshrq_n_u16(u, 14)));
+        }
+        step.finish(i, s);
+        row16Scalar(src + i, acc + i, dst + i, n - i, p, s);
+    }
+#endif
+
+    const EmaKernel& emaKernel()
+    {
+        static const EmaKernel k = emaKernels().back();
+        return k;
+    }
+}
+
+std::vector<EmaKernel> ema_detail::emaKernels()
+{
+    std::vector<EmaKernel> out{{row8Scalar, row16Scalar, "scalar"}};
+#if defined(DUALCAM_EMA_X86)
+    if (cv::checkHardwareSupport(CV_CPU_SSSE3)) out.push_back({row8Ssse3, row16Ssse3, "SSSE3"});
+    if (cv::checkHardwareSupport(CV_CPU_AVX2)) out.push_back({row8Avx2, row16Avx2, "AVX2"});
+#elif defined(DUALCAM_EMA_NEON)
+    out.push_back({row8Neon, row16Neon, "NEON"});
+#endif
+    return out;
+}
+
+bool temporalEmaSupported(int depth)
+{
+    return depth == CV_8U || depth == CV_16U;
+}
+
+const char* temporalEmaKernel()
+{
+    return emaKernel().name;
+}
+
+cv::Mat temporalEma(const cv::Mat& frame, TemporalEmaState& state, int bufferSize)
+{
+    CV_Assert(temporalEmaSupported(frame.depth()) && bufferSize >= 2);
+    const bool eight = frame.depth() == CV_8U;
+    const int accType = CV_MAKETYPE(CV_16S, frame.channels());
+    cv::Mat& acc = state.acc;
+    if (acc.size() != frame.size() || acc.type() != accType) {
+        frame.convertTo(acc, accType, eight ? 128.0 : 0.5);
+        return frame;
+    }
+
+    EmaParams p;
+    p.a = cvRound(32768.0 / bufferSize);
+    p.thr = cvRound(kNoiseSigmas * (state.noise > 0.0 ? state.noise : kInitialNoise));
+    p.slope = (32767 - p.a) / p.thr;
+
+    cv::Mat out(frame.size(), frame.type());
+    int rows = frame.rows;
+    int n = frame.cols * frame.channels();
+    if (frame.isContinuous() && acc.isContinuous()) {
+        n *= rows;
+        rows = 1;
+    }
+    const EmaKernel& k = emaKernel();
+    EmaStats stats;
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < n; x += kChunk) {
+            const int len = std::min(kChunk, n - x);
+            if (eight) k.row8(frame.ptr<uint8_t>(y) + x, acc.ptr<int16_t>(y) + x, out.ptr<uint8_t>(y) + x, len, p, stats);
+            else k.row16(frame.ptr<uint16_t>(y) + x, acc.ptr<int16_t>(y) + x, out.ptr<uint16_t>(y) + x, len, p, stats);
+        }
+    }
+
+    if (stats.count > 0) {
+        const double sigma = std::min(kMaxNoise, std::max(kMinNoise,
+            static_cast<double>(stats.sum) / stats.count / kTruncatedMean));
+        state.noise = state.noise > 0.0 ? state.noise + kNoiseSmoothing * (sigma - state.noise) : sigma;
+    }
+    return out;
+}
@@ -0,0 +1,39 @@
+#ifndef TEMPORAL_DENOISE_H
+#define TEMPORAL_DENOISE_H
+
+#include <opencv2/core.hpp>
+
+/* Per-camera history of temporalEma(). acc is CV_16S fixed point (Q8.7 for
+   8-bit frames, the top 15 bits for 16-bit ones); noise is the running
+   estimate of the frame-to-history difference of static pixels, in the
+   same units (128 per 8-bit level). */
+struct TemporalEmaState {
+    cv::Mat acc;
+    double noise = 0.0;
+
+    void reset()
+    {
+        acc.release();
+        noise = 0.0;
+    }
+};
+
+/* Motion-adaptive temporal exponential moving average for 8- and 16-bit
+   frames of any channel count. Where a sample differs from its history by
+   less than the noise model (3 sigma) it is averaged with weight
+   1 / bufferSize; above that the weight ramps up to 1 over another 3 sigma,
+   so moving regions follow at once and static ones keep the full average.
+   Update, output and the noise statistics are one vectorised pass: AVX2 or
+   SSSE3 picked at run time on x86, NEON on ARM, all bit-exact with the
+   scalar loop. Below the ramp the output stays within 1 LSB of a float EMA
+   for 8-bit frames and bufferSize + 2 counts for 16-bit ones (checked by
+   test_temporal_denoise.cpp). A missing or mismatched accumulator is seeded from the
+   frame, which is returned as is. */
+cv::Mat temporalEma(const cv::Mat& frame, TemporalEmaState& state, int bufferSize);
+
+bool temporalEmaSupported(int depth);
+
+/* Name of the kernel temporalEma() dispatches to on this CPU. */
+const char* temporalEmaKernel();
+
+#endif // TEMPORAL_DENOISE_H
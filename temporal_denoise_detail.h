@@ -0,0 +1,38 @@
+#ifndef TEMPORAL_DENOISE_DETAIL_H
+#define TEMPORAL_DENOISE_DETAIL_H
+
+#include <cstdint>
+#include <vector>
+
+/* Row kernels behind temporalEma(), exposed for test_temporal_denoise.cpp. */
+namespace ema_detail {
+    /* Upper bound of the noise estimate, in accumulator units. */
+    constexpr double kMaxNoise = 2560.0;
+
+    /* a is the static weight in Q15; above thr the weight grows by slope
+       per unit of excess difference, reaching at most 32767 after another
+       thr. */
+    struct EmaParams {
+        int a;
+        int thr;
+        int slope;
+    };
+
+    /* Sum and count of |t - acc| over the samples treated as static. */
+    struct EmaStats {
+        int64_t sum = 0;
+        int64_t count = 0;
+    };
+
+    struct EmaKernel {
+        void (*row8)(const uint8_t*, int16_t*, uint8_t*, int, const EmaParams&, EmaStats&);
+        void (*row16)(const uint16_t*, int16_t*, uint16_t*, int, const EmaParams&, EmaStats&);
+        const char* name;
+    };
+
+    /* The scalar loop first, then every SIMD kernel this build and CPU can
+       run, fastest last. */
+    std::vector<EmaKernel> emaKernels();
+}
+
+#endif // TEMPORAL_DENOISE_DETAIL_H
@@ -0,0 +1,126 @@
+#include "temporal_stack.h"
+#include "temporal_stack_detail.h"
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <utility>
+
+namespace {
+    /* All samples of one tile together should stay within L2. */
+    constexpr int64_t kTileBytes = 256 * 1024;
+
+    using stack_detail::Network;
+
+    /* Batcher's odd-even merge sort for n inputs, smallest first. Pruning
+       the comparators of the next power of two that touch indices >= n is
+       still a sorting network: those inputs act as +inf and never move. */
+    Network buildNetwork(int n)
+    {
+        Network out;
+        for (int p = 1; p < n; p <<= 1)
+            for (int k = p; k >= 1; k >>= 1)
+                for (int j = k % p; j + k < n; j += 2 * k)
+                    for (int i = 0; i < std::min(k, n - j - k); ++i)
+                        if ((i + j) / (2 * p) == (i + j + k) / (2 * p))
+                            out.emplace_back(i + j, i + j + k);
+        return out;
+    }
+}
+
+const stack_detail::Network& stack_detail::network(int n)
+{
+    static const std::array<Network, kMaxStackDepth + 1> nets = []() {
+        std::array<Network, kMaxStackDepth + 1> a;
+        for (int i = 0; i <= kMaxStackDepth; ++i) a[i] = buildNetwork(i);
+        return a;
+    }();
+    return nets[n];
+}
+
+int stackDepthFor(const cv::Size& size, int type, int requested, int64_t budgetBytes)
+{
+    const int64_t frameBytes = static_cast<int64_t>(size.area()) * CV_ELEM_SIZE(type);
+    if (frameBytes <= 0) return 0;
+    return static_cast<int>(std::min<int64_t>({requested, kMaxStackDepth, budgetBytes / frameBytes}));
+}
+
+void TemporalStack::release()
+{
+    m_slots.clear();
+    reset();
+}
+
+void TemporalStack::refresh(const cv::Mat& frame, const std::vector<cv::Rect>& regions)
+{
+    if (m_filled == 0 || m_slots[0].size() != frame.size() || m_slots[0].type() != frame.type()) return;
+    const cv::Rect bounds(0, 0, frame.cols, frame.rows);
+    for (const cv::Rect& region : regions) {
+        const cv::Rect r = region & bounds;
+        if (r.empty()) continue;
+        for (int k = 0; k < m_filled; ++k) frame(r).copyTo(m_slots[k](r));
+    }
+}
+
+int64_t TemporalStack::bytes() const
+{
+    int64_t total = 0;
+    for (const cv::Mat& s : m_slots) total += static_cast<int64_t>(s.total() * s.elemSize());
+    return total;
+}
+
+cv::Mat TemporalStack::process(const cv::Mat& frame, int depth, TemporalMode mode)
+{
+    depth = std::min(depth, kMaxStackDepth);
+    if (depth < 2 || frame.empty()) {
+        release();
+        return frame;
+    }
+    if (static_cast<int>(m_slots.size()) != depth || m_slots[0].size() != frame.size()
+        || m_slots[0].type() != frame.type()) {
+        m_slots.assign(depth, cv::Mat());
+        for (cv::Mat& s : m_slots) s.create(frame.size(), frame.type());
+        reset();
+        std::cerr << "[denoise] ring " << depth << " x " << frame.total() * frame.elemSize() / 1e6
+                  << " MB = " << bytes() / 1e6 << " MB" << std::endl;
+    }
+    frame.copyTo(m_slots[m_next]);
+    m_next = (m_next + 1) % depth;
+    m_filled = std::min(m_filled + 1, depth);
+    const int n = m_filled;
+    if (n < 2) return frame;
+
+    /* Slots fill from index 0, so the first n hold the samples. */
+    const Network& net = stack_detail::network(n);
+    const int trim = mode == TemporalMode::TrimmedMean ? n / 4 : 0;
+    const int sumType = CV_MAKETYPE(frame.depth() == CV_8U ? CV_16U : CV_32S, frame.channels());
+    const int64_t rowBytes = static_cast<int64_t>(frame.cols) * frame.elemSize();
+    const int tileRows = static_cast<int>(std::max<int64_t>(1, kTileBytes / (rowBytes * n)));
+    const int tiles = (frame.rows + tileRows - 1) / tileRows;
+
+    /* Tiles run on the calling stage worker: every camera already has one,
+       and OpenCV runs concurrent parallel_for_ calls from several threads
+       one after another. */
+    cv::Mat out(frame.size(), frame.type());
+    std::vector<cv::Mat> v(n);
+    cv::Mat tmp, sum;
+    for (int t = 0; t < tiles; ++t) {
+        const cv::Range rows(t * tileRows, std::min(frame.rows, (t + 1) * tileRows));
+        for (int k = 0; k < n; ++k) m_slots[k].rowRange(rows).copyTo(v[k]);
+        for (const auto& c : net) {
+            cv::min(v[c.first], v[c.second], tmp);
+            cv::max(v[c.first], v[c.second], v[c.second]);
+            std::swap(v[c.first], tmp);
+        }
+        cv::Mat dst = out.rowRange(rows);
+        if (mode == TemporalMode::Median) {
+            if (n % 2) v[n / 2].copyTo(dst);
+            else cv::addWeighted(v[n / 2 - 1], 0.5, v[n / 2], 0.5, 0.0, dst);
+        } else {
+            v[trim].convertTo(sum, sumType);
+            for (int k = trim + 1; k < n - trim; ++k) cv::add(sum, v[k], sum, cv::noArray(), sumType);
+            sum.convertTo(dst, frame.type(), 1.0 / (n - 2 * trim));
+        }
+    }
+    return out;
+}
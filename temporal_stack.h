@@ -0,0 +1,44 @@
+#ifndef TEMPORAL_STACK_H
+#define TEMPORAL_STACK_H
+
+#include <opencv2/core.hpp>
+
+#include <cstdint>
+#include <vector>
+
+enum class TemporalMode { Ema, Median, TrimmedMean };
+
+constexpr int kMaxStackDepth = 16;
+
+/* Ring of the last frames of one camera for per-pixel order statistics,
+   which reject hot pixels and single-frame spikes instead of smearing them
+   like the EMA does. Slots are allocated once per size, type and depth and
+   reused. Each frame is walked in row tiles on the calling thread; within
+   a tile the samples are sorted by a Batcher odd-even merge network of
+   cv::min / cv::max passes (OpenCV's SIMD kernels, dispatched at run time)
+   while the tile is still in cache. */
+class TemporalStack {
+public:
+    /* Adds frame to a ring of depth slots and returns the per-pixel median
+       or the mean of the middle half of the samples so far. */
+    cv::Mat process(const cv::Mat& frame, int depth, TemporalMode mode);
+    /* Overwrites the given regions of every stored sample with frame, so
+       moving areas restart from the current frame while the rest of the
+       history is kept. */
+    void refresh(const cv::Mat& frame, const std::vector<cv::Rect>& regions);
+    /* Forgets the samples, keeps the memory. */
+    void reset() { m_next = m_filled = 0; }
+    void release();
+    int64_t bytes() const;
+
+private:
+    std::vector<cv::Mat> m_slots;
+    int m_next = 0;
+    int m_filled = 0;
+};
+
+/* Deepest ring, at most requested and kMaxStackDepth, whose slots for
+   frames of this size and type fit in budgetBytes. */
+int stackDepthFor(const cv::Size& size, int type, int requested, int64_t budgetBytes);
+
+#endif // TEMPORAL_STACK_H
@@ -0,0 +1,17 @@
+#ifndef TEMPORAL_STACK_DETAIL_H
+#define TEMPORAL_STACK_DETAIL_H
+
+#include <utility>
+#include <vector>
+
+/* Sorting networks behind TemporalStack, exposed for
+   test_temporal_stack.cpp. */
+namespace stack_detail {
+    using Network = std::vector<std::pair<int, int>>;
+
+    /* Comparators that sort n samples, smallest first, for n up to
+       kMaxStackDepth; each swaps its pair when the first is larger. */
+    const Network& network(int n);
+}
+
+#endif // TEMPORAL_STACK_DETAIL_H
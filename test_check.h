@@ -0,0 +1,30 @@
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+#include <iostream>
+#include <string>
+
+/* Minimal harness shared by the test_*.cpp programs: check() reports every
+   failed condition, testResult() prints the verdict and is returned from
+   main(), so ctest sees a failure as a non-zero exit. */
+inline int& testFailures()
+{
+    static int failures = 0;
+    return failures;
+}
+
+inline void check(bool ok, const std::string& what)
+{
+    if (!ok) {
+        std::cout << "FAIL " << what << std::endl;
+        ++testFailures();
+    }
+}
+
+inline int testResult()
+{
+    std::cout << (testFailures() ? "FAILED" : "OK") << std::endl;
+    return testFailures() ? 1 : 0;
+}
+
+#endif // TEST_CHECK_H
@@ -0,0 +1,122 @@
+/* Fused focus metrics: SIMD rows against the scalar loop, whole frames
+   against a per-pixel reference. Built with DUALCAM_BUILD_TESTS. */
+#include "focus_metrics.h"
+#include "focus_metrics_detail.h"
+#include "pixel_depth.h"
+#include "test_check.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace focus_detail;
+
+namespace {
+    bool sameSums(const FocusSums& a, const FocusSums& b)
+    {
+        return a.lap == b.lap && a.lap2 == b.lap2 && a.ten == b.ten && a.bren == b.bren && a.count == b.count;
+    }
+
+    /* The SIMD row kernel against the scalar one on rows long enough to
+       cross the 32-bit flush interval (256 steps of 8 pixels at 8 bits, 16
+       at 10 bits), for random data and for the alternating 0 / max pattern
+       that maximises every product. */
+    template <typename T>
+    void rowsMatchScalar(std::mt19937& rng, int maxValue, const char* name)
+    {
+        std::uniform_int_distribution<int> value(0, maxValue), start(1, 9);
+        for (int width = 3; width < 4200; width += 61) {
+            for (int pattern = 0; pattern < 2; ++pattern) {
+                std::vector<T> img(static_cast<size_t>(width) * 3);
+                for (size_t i = 0; i < img.size(); ++i) {
+                    const size_t x = i % width, y = i / width;
+                    img[i] = static_cast<T>(pattern ? ((x + y) % 2 ? maxValue : 0) : value(rng));
+                }
+                const int x0 = std::min(start(rng), width - 1);
+                FocusSums simd, scalar;
+                accumulateRow(&img[0], &img[width], &img[2 * width], x0, width - 1, simd);
+                accumulateScalar(&img[0], &img[width], &img[2 * width], x0, width - 1, scalar);
+                check(sameSums(simd, scalar),
+                      std::string(name) + " row width=" + std::to_string(width) + " pattern=" + std::to_string(pattern));
+            }
+        }
+    }
+
+    /* Straightforward per-pixel evaluation over the same tile partition. */
+    template <typename T>
+    std::vector<FocusSums> referenceTiles(const cv::Mat& m, int gw, int gh)
+    {
+        const int shift = sizeof(T) == 1 ? 0 : kShift16;
+        auto at = [&](int y, int x) { return static_cast<int>(m.at<T>(y, x)) >> shift; };
+        std::vector<int> edges(gw + 1);
+        for (int i = 0; i <= gw; ++i) edges[i] = 1 + (m.cols - 2) * i / gw;
+        std::vector<FocusSums> tiles(static_cast<size_t>(gw) * gh);
+        for (int y = 1; y < m.rows - 1; ++y) {
+            const int ty = std::min(gh - 1, (y - 1) * gh / (m.rows - 2));
+            for (int x = 1; x < m.cols - 1; ++x) {
+                int tx = 0;
+                while (x >= edges[tx + 1]) ++tx;
+                const int lap = at(y - 1, x) + at(y + 1, x) + at(y, x - 1) + at(y, x + 1) - 4 * at(y, x);
+                const int gx = (at(y - 1, x + 1) - at(y - 1, x - 1)) + 2 * (at(y, x + 1) - at(y, x - 1))
+                             + (at(y + 1, x + 1) - at(y + 1, x - 1));
+                const int gy = (at(y + 1, x - 1) - at(y - 1, x - 1)) + 2 * (at(y + 1, x) - at(y - 1, x))
+                             + (at(y + 1, x + 1) - at(y - 1, x + 1));
+                const int b = at(y, x + 1) - at(y, x - 1);
+                FocusSums& s = tiles[static_cast<size_t>(ty) * gw + tx];
+                s.lap += lap;
+                s.lap2 += static_cast<int64_t>(lap) * lap;
+                s.ten += static_cast<int64_t>(gx) * gx + static_cast<int64_t>(gy) * gy;
+                s.bren += static_cast<int64_t>(b) * b;
+                ++s.count;
+            }
+        }
+        return tiles;
+    }
+
+    /* measureFocus() on whole frames, odd sizes and grids whose tile edges
+       fall inside and at the end of SIMD blocks, against the reference. */
+    template <typename T>
+    void framesMatchReference(std::mt19937& rng, int type, int maxValue, const char* name)
+    {
+        const cv::Size sizes[] = {{3, 3}, {17, 9}, {101, 37}, {333, 65}, {640, 48}};
+        const cv::Size grids[] = {{1, 1}, {3, 2}, {8, 6}, {7, 5}};
+        std::uniform_int_distribution<int> value(0, maxValue);
+        const double k = sizeof(T) == 1 ? 1.0 : (1 << kShift16) / kStep16;
+        const double k2 = k * k;
+        for (const cv::Size& size : sizes) {
+            cv::Mat m(size, type);
+            for (int y = 0; y < m.rows; ++y)
+                for (int x = 0; x < m.cols; ++x) m.at<T>(y, x) = static_cast<T>(value(rng));
+            for (const cv::Size& grid : grids) {
+                if (grid.width > size.width - 2 || grid.height > size.height - 2) continue;
+                const FocusMetrics fm = measureFocus(m, grid);
+                const std::vector<FocusSums> ref = referenceTiles<T>(m, grid.width, grid.height);
+                FocusSums total;
+                for (const FocusSums& t : ref) total += t;
+                const std::string tag = std::string(name) + " " + std::to_string(size.width) + "x"
+                                      + std::to_string(size.height) + " grid " + std::to_string(grid.width) + "x"
+                                      + std::to_string(grid.height);
+                check(fm.laplacian == laplacianVariance(total) * k2, tag + " laplacian");
+                check(fm.tenengrad == static_cast<double>(total.ten) / total.count * k2, tag + " tenengrad");
+                check(fm.brenner == static_cast<double>(total.bren) / total.count * k2, tag + " brenner");
+                bool mapOk = fm.map.rows == grid.height && fm.map.cols == grid.width;
+                for (int ty = 0; mapOk && ty < grid.height; ++ty)
+                    for (int tx = 0; mapOk && tx < grid.width; ++tx)
+                        mapOk = fm.map.at<double>(ty, tx)
+                                == laplacianVariance(ref[static_cast<size_t>(ty) * grid.width + tx]) * k2;
+                check(mapOk, tag + " map");
+            }
+        }
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(12345);
+    rowsMatchScalar<uint8_t>(rng, 255, "8-bit");
+    rowsMatchScalar<uint16_t>(rng, 65535, "16-bit");
+    framesMatchReference<uint8_t>(rng, CV_8UC1, 255, "8-bit");
+    framesMatchReference<uint16_t>(rng, CV_16UC1, 65535, "16-bit");
+    return testResult();
+}
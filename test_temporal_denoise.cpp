@@ -0,0 +1,130 @@
+/* Fixed-point temporal EMA: SIMD kernels against the scalar Q15 loop and
+   temporalEma() against cv::accumulateWeighted. Built with
+   DUALCAM_BUILD_TESTS. */
+#include "temporal_denoise.h"
+#include "temporal_denoise_detail.h"
+#include "test_check.h"
+
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ema_detail;
+
+namespace {
+    /* Every SIMD kernel against the scalar Q15 loop: accumulator, output
+       and noise statistics must match bit for bit, including the tails
+       and samples on the adaptive ramp. */
+    void kernelsMatchScalar(std::mt19937& rng)
+    {
+        const std::vector<EmaKernel> all = emaKernels();
+        const EmaKernel& scalar = all.front();
+        const std::vector<EmaKernel> kernels(all.begin() + 1, all.end());
+        std::cout << "SIMD kernels:";
+        for (const EmaKernel& k : kernels) std::cout << " " << k.name;
+        std::cout << " (dispatch: " << temporalEmaKernel() << ")" << std::endl;
+
+        /* An 8-bit accumulator never leaves [0, 255 << 7]: the EMA does not
+           overshoot its targets. */
+        std::uniform_int_distribution<int> len(1, 300), u8(0, 255), u16(0, 65535), q8(0, 255 << 7), q16(0, 32767);
+        std::uniform_int_distribution<int> buf(2, 30), thr(64, 2560);
+        for (int iter = 0; iter < 2000; ++iter) {
+            const int n = len(rng);
+            EmaParams p;
+            p.a = cvRound(32768.0 / buf(rng));
+            p.thr = thr(rng);
+            p.slope = (32767 - p.a) / p.thr;
+
+            std::vector<uint8_t> s8(n);
+            std::vector<uint16_t> s16(n);
+            std::vector<int16_t> acc8Init(n), acc16Init(n);
+            for (int i = 0; i < n; ++i) {
+                s8[i] = static_cast<uint8_t>(u8(rng));
+                s16[i] = static_cast<uint16_t>(u16(rng));
+                acc8Init[i] = static_cast<int16_t>(q8(rng));
+                acc16Init[i] = static_cast<int16_t>(q16(rng));
+            }
+
+            std::vector<int16_t> refAcc8 = acc8Init, refAcc16 = acc16Init;
+            std::vector<uint8_t> ref8(n);
+            std::vector<uint16_t> ref16(n);
+            EmaStats ref8Stats, ref16Stats;
+            scalar.row8(s8.data(), refAcc8.data(), ref8.data(), n, p, ref8Stats);
+            scalar.row16(s16.data(), refAcc16.data(), ref16.data(), n, p, ref16Stats);
+
+            for (const EmaKernel& k : kernels) {
+                std::vector<int16_t> acc8 = acc8Init, acc16 = acc16Init;
+                std::vector<uint8_t> out8(n);
+                std::vector<uint16_t> out16(n);
+                EmaStats st8, st16;
+                k.row8(s8.data(), acc8.data(), out8.data(), n, p, st8);
+                k.row16(s16.data(), acc16.data(), out16.data(), n, p, st16);
+                const std::string tag = std::string(k.name) + " n=" + std::to_string(n);
+                check(acc8 == refAcc8 && out8 == ref8, tag + " 8-bit pixels");
+                check(st8.sum == ref8Stats.sum && st8.count == ref8Stats.count, tag + " 8-bit stats");
+                check(acc16 == refAcc16 && out16 == ref16, tag + " 16-bit pixels");
+                check(st16.sum == ref16Stats.sum && st16.count == ref16Stats.count, tag + " 16-bit stats");
+            }
+        }
+    }
+
+    /* temporalEma() against cv::accumulateWeighted with the same weight.
+       The noise model is pinned at its maximum so no sample reaches the
+       adaptive ramp and both sides compute a plain EMA. */
+    void matchesFloatEma(int depth, int bufferSize)
+    {
+        const cv::Size size(97, 31);
+        const int a = cvRound(32768.0 / bufferSize);
+        const double alpha = a / 32768.0;
+        const double spread = depth == CV_8U ? 10.0 : 2560.0;
+        const double bound = depth == CV_8U ? 1.0 : bufferSize + 2.0;
+
+        cv::Mat base(size, CV_64F);
+        cv::randu(base, spread, (depth == CV_8U ? 255.0 : 65535.0) - spread);
+        TemporalEmaState state;
+        cv::Mat ref;
+        double worst = 0.0;
+        for (int t = 0; t < 200; ++t) {
+            cv::Mat jitter(size, CV_64F), frame;
+            cv::randu(jitter, -spread, spread);
+            cv::Mat(base + jitter).convertTo(frame, depth);
+            state.noise = kMaxNoise;
+            const cv::Mat out = temporalEma(frame, state, bufferSize);
+            if (ref.empty()) frame.convertTo(ref, CV_64F);
+            else cv::accumulateWeighted(frame, ref, alpha);
+
+            cv::Mat outF, diff;
+            out.convertTo(outF, CV_64F);
+            if (depth == CV_8U) {
+                cv::Mat refRounded;
+                ref.convertTo(refRounded, CV_8U);
+                refRounded.convertTo(refRounded, CV_64F);
+                cv::absdiff(outF, refRounded, diff);
+            } else {
+                cv::absdiff(outF, ref, diff);
+            }
+            double maxDiff = 0.0;
+            cv::minMaxLoc(diff, nullptr, &maxDiff);
+            worst = std::max(worst, maxDiff);
+        }
+        std::cout << (depth == CV_8U ? "8" : "16") << "-bit N=" << bufferSize << " max |fixed - float| = " << worst
+                  << " (bound " << bound << ")" << std::endl;
+        check(worst <= bound, "float EMA bound");
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(12345);
+    cv::theRNG().state = 12345;
+    kernelsMatchScalar(rng);
+    for (int n : {2, 3, 4, 8, 16, 30}) {
+        matchesFloatEma(CV_8U, n);
+        matchesFloatEma(CV_16U, n);
+    }
+    return testResult();
+}
@@ -0,0 +1,129 @@
+/* Temporal frame ring: the sorting network of every ring size, and the
+   median and trimmed mean against std::nth_element and a sorted reference.
+   Built with DUALCAM_BUILD_TESTS. */
+#include "temporal_stack.h"
+#include "temporal_stack_detail.h"
+#include "test_check.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace stack_detail;
+
+namespace {
+    /* Every ring size sorts all 2^n inputs of zeros and ones, which by the
+       0-1 principle covers any input, and random values with duplicates
+       come out as std::sort leaves them. */
+    void networksSort(std::mt19937& rng)
+    {
+        std::uniform_int_distribution<int> value(0, 20);
+        for (int n = 2; n <= kMaxStackDepth; ++n) {
+            const Network& net = network(n);
+            bool ok = true;
+            for (uint32_t bits = 0; ok && bits < (1u << n); ++bits) {
+                std::vector<int> v(n);
+                for (int i = 0; i < n; ++i) v[i] = (bits >> i) & 1;
+                for (const auto& c : net)
+                    if (v[c.first] > v[c.second]) std::swap(v[c.first], v[c.second]);
+                ok = std::is_sorted(v.begin(), v.end());
+            }
+            for (int iter = 0; ok && iter < 1000; ++iter) {
+                std::vector<int> v(n);
+                for (int& x : v) x = value(rng);
+                std::vector<int> sorted = v;
+                std::sort(sorted.begin(), sorted.end());
+                for (const auto& c : net)
+                    if (v[c.first] > v[c.second]) std::swap(v[c.first], v[c.second]);
+                ok = v == sorted;
+            }
+            check(ok, "network n=" + std::to_string(n) + " (" + std::to_string(net.size()) + " comparators)");
+        }
+    }
+
+    /* Exact order statistics of one pixel's samples. The mean of the two
+       middle values and the trimmed mean are rounded on the way back to
+       the frame depth, so those may differ from the exact value by half a
+       count. */
+    double referenceMedian(std::vector<double> s)
+    {
+        const size_t n = s.size();
+        std::nth_element(s.begin(), s.begin() + n / 2, s.end());
+        const double hi = s[n / 2];
+        if (n % 2) return hi;
+        return (*std::max_element(s.begin(), s.begin() + n / 2) + hi) / 2.0;
+    }
+
+    double referenceTrimmedMean(std::vector<double> s)
+    {
+        const int n = static_cast<int>(s.size());
+        const int trim = n / 4;
+        std::sort(s.begin(), s.end());
+        double sum = 0.0;
+        for (int k = trim; k < n - trim; ++k) sum += s[k];
+        return sum / (n - 2 * trim);
+    }
+
+    /* TemporalStack::process() for every ring size, fed past the point
+       where the ring wraps, on frames tall enough for several tiles with a
+       partial last one. */
+    void ringMatchesReference(std::mt19937& rng, int type, int maxValue, TemporalMode mode, const char* name)
+    {
+        const cv::Size size(257, 50);
+        std::uniform_int_distribution<int> value(0, maxValue);
+        for (int depth = 2; depth <= kMaxStackDepth; ++depth) {
+            TemporalStack stack;
+            std::vector<cv::Mat> history;
+            double worst = 0.0;
+            bool oddExact = true;
+            for (int t = 0; t < depth + 3; ++t) {
+                cv::Mat frame(size, type);
+                for (int y = 0; y < frame.rows; ++y) {
+                    if (frame.depth() == CV_8U) {
+                        uint8_t* row = frame.ptr<uint8_t>(y);
+                        for (int i = 0; i < frame.cols * frame.channels(); ++i) row[i] = static_cast<uint8_t>(value(rng));
+                    } else {
+                        uint16_t* row = frame.ptr<uint16_t>(y);
+                        for (int i = 0; i < frame.cols * frame.channels(); ++i) row[i] = static_cast<uint16_t>(value(rng));
+                    }
+                }
+                history.push_back(frame);
+                if (static_cast<int>(history.size()) > depth) history.erase(history.begin());
+                const cv::Mat out = stack.process(frame, depth, mode);
+                const int n = static_cast<int>(history.size());
+                if (n < 2) continue;
+
+                std::vector<double> samples(n);
+                for (int y = 0; y < size.height; ++y) {
+                    for (int i = 0; i < size.width * out.channels(); ++i) {
+                        for (int k = 0; k < n; ++k)
+                            samples[k] = history[k].depth() == CV_8U ? history[k].ptr<uint8_t>(y)[i]
+                                                                     : history[k].ptr<uint16_t>(y)[i];
+                        const double got = out.depth() == CV_8U ? out.ptr<uint8_t>(y)[i] : out.ptr<uint16_t>(y)[i];
+                        const double want = mode == TemporalMode::Median ? referenceMedian(samples)
+                                                                         : referenceTrimmedMean(samples);
+                        worst = std::max(worst, std::abs(got - want));
+                        if (mode == TemporalMode::Median && n % 2 && got != want) oddExact = false;
+                    }
+                }
+            }
+            const std::string tag = std::string(name) + " depth=" + std::to_string(depth);
+            check(oddExact, tag + " odd median");
+            check(worst <= 0.5 + 1e-3, tag + " max |out - reference| = " + std::to_string(worst));
+        }
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(12345);
+    networksSort(rng);
+    ringMatchesReference(rng, CV_MAKETYPE(CV_8U, 3), 255, TemporalMode::Median, "8-bit median");
+    ringMatchesReference(rng, CV_MAKETYPE(CV_8U, 3), 255, TemporalMode::TrimmedMean, "8-bit trimmed");
+    ringMatchesReference(rng, CV_16UC1, 65535, TemporalMode::Median, "16-bit median");
+    ringMatchesReference(rng, CV_16UC1, 65535, TemporalMode::TrimmedMean, "16-bit trimmed");
+    return testResult();
+}
@@ -0,0 +1,411 @@
+#include "v4l2_capture.h"
+
+#ifdef __linux__
+#include <opencv2/imgproc.hpp>
+
+#include <linux/videodev2.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#endif
+
+#ifdef __linux__
+
+namespace {
+    int xioctl(int fd, unsigned long req, void* arg)
+    {
+        int r;
+        do { r = ioctl(fd, req, arg); } while (r == -1 && errno == EINTR);
+        return r;
+    }
+
+    /* Buffers a lent frame can hold outside the driver: kMaxPinnedFrames in
+       the pipeline plus the one being pushed, which is copied out of the
+       buffer when the queue already holds a lent frame. The rest stay
+       queued so the driver always has somewhere to write while the
+       application catches up; with fewer it skips frames and the sequence
+       gaps are counted as drops. */
+    constexpr unsigned kLentBuffers = static_cast<unsigned>(kMaxPinnedFrames) + 1;
+    constexpr unsigned kDriverQueued = 3;
+    constexpr unsigned kBufferCount = kLentBuffers + kDriverQueued;
+
+    const uint32_t kPreferredFormats[] = {
+        V4L2_PIX_FMT_GREY,
+        V4L2_PIX_FMT_NV12,
+        V4L2_PIX_FMT_YUYV,
+        V4L2_PIX_FMT_UYVY,
+        V4L2_PIX_FMT_BGR24,
+        V4L2_PIX_FMT_RGB24,
+    };
+
+    bool setControl(int fd, uint32_t id, int64_t value)
+    {
+        v4l2_queryctrl q{};
+        q.id = id;
+        if (xioctl(fd, VIDIOC_QUERYCTRL, &q) < 0 || (q.flags & V4L2_CTRL_FLAG_DISABLED)) return false;
+        v4l2_control c{};
+        c.id = id;
+        c.value = static_cast<int32_t>(std::clamp<int64_t>(value, q.minimum, q.maximum));
+        return xioctl(fd, VIDIOC_S_CTRL, &c) == 0;
+    }
+
+    bool scaledGain(int fd, uint32_t id, double gain)
+    {
+        v4l2_queryctrl q{};
+        q.id = id;
+        if (xioctl(fd, VIDIOC_QUERYCTRL, &q) < 0 || (q.flags & V4L2_CTRL_FLAG_DISABLED)) return false;
+        const double unity = q.default_value > 0 ? q.default_value : std::max(1, q.minimum);
+        return setControl(fd, id, std::llround(unity * gain));
+    }
+
+    /* Little-endian, LSB-aligned 16-bit containers. */
+    const uint32_t kHighBitFormats[] = {
+        V4L2_PIX_FMT_Y16,
+        V4L2_PIX_FMT_Y12,
+        V4L2_PIX_FMT_Y10,
+    };
+
+    int highBitDepthOf(uint32_t f)
+    {
+        switch (f) {
+            case V4L2_PIX_FMT_Y16: return 16;
+            case V4L2_PIX_FMT_Y12: return 12;
+            case V4L2_PIX_FMT_Y10: return 10;
+            default: return 0;
+        }
+    }
+
+    bool isSupportedFormat(uint32_t f)
+    {
+        for (uint32_t p : kPreferredFormats) if (p == f) return true;
+        return highBitDepthOf(f) != 0;
+    }
+}
+
+/* Shared between the capture object and every frame still referencing a
+   driver buffer: the mappings and the fd stay valid until the last frame is
+   released, even if the capture was closed in the meantime. */
+struct V4L2Capture::State {
+    struct Buffer {
+        void* start = MAP_FAILED;
+        size_t length = 0;
+    };
+
+    int fd = -1;
+    std::vector<Buffer> buffers;
+    std::atomic<bool> streaming{false};
+    uint32_t pixfmt = 0;
+    int width = 0;
+    int height = 0;
+    int bytesPerLine = 0;
+    /* False when the driver granted too few buffers to lend them out. */
+    bool lend = true;
+
+    ~State()
+    {
+        for (Buffer& b : buffers) {
+            if (b.start != MAP_FAILED) munmap(b.start, b.length);
+        }
+        if (fd >= 0) ::close(fd);
+    }
+
+    void requeue(uint32_t index)
+    {
+        if (!streaming) return;
+        v4l2_buffer buf{};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = index;
+        xioctl(fd, VIDIOC_QBUF, &buf);
+    }
+};
+
+V4L2Capture::V4L2Capture() = default;
+
+V4L2Capture::~V4L2Capture()
+{
+    close();
+}
+
+bool V4L2Capture::available()
+{
+    return true;
+}
+
+bool V4L2Capture::probe(const std::string& device, std::string* card, std::string* busInfo)
+{
+    const int fd = ::open(device.c_str(), O_RDWR | O_NONBLOCK);
+    if (fd < 0) return false;
+
+    bool ok = false;
+    v4l2_capability cap{};
+    if (xioctl(fd, VIDIOC_QUERYCAP, &cap) == 0) {
+        const uint32_t caps = (cap.capabilities & V4L2_CAP_DEVICE_CAPS) ? cap.device_caps : cap.capabilities;
+        if ((caps & V4L2_CAP_VIDEO_CAPTURE) && (caps & V4L2_CAP_STREAMING)) {
+            v4l2_fmtdesc desc{};
+            desc.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            while (!ok && xioctl(fd, VIDIOC_ENUM_FMT, &desc) == 0) {
+                ok = isSupportedFormat(desc.pixelformat);
+                ++desc.index;
+            }
+        }
+        if (ok && card) *card = reinterpret_cast<const char*>(cap.card);
+        if (ok && busInfo) *busInfo = reinterpret_cast<const char*>(cap.bus_info);
+    }
+    ::close(fd);
+    return ok;
+}
+
+bool V4L2Capture::open(const std::string& device, int w, int h, int fps, bool highBitDepth)
+{
+    close();
+    auto st = std::make_shared<State>();
+    st->fd = ::open(device.c_str(), O_RDWR | O_NONBLOCK);
+    if (st->fd < 0) return false;
+
+    v4l2_capability cap{};
+    if (xioctl(st->fd, VIDIOC_QUERYCAP, &cap) < 0) return false;
+    const uint32_t caps = (cap.capabilities & V4L2_CAP_DEVICE_CAPS) ? cap.device_caps : cap.capabilities;
+    if (!(caps & V4L2_CAP_VIDEO_CAPTURE) || !(caps & V4L2_CAP_STREAMING)) return false;
+
+    std::vector<uint32_t> order;
+    if (highBitDepth) order.insert(order.end(), std::begin(kHighBitFormats), std::end(kHighBitFormats));
+    order.insert(order.end(), std::begin(kPreferredFormats), std::end(kPreferredFormats));
+    if (!highBitDepth) order.insert(order.end(), std::begin(kHighBitFormats), std::end(kHighBitFormats));
+
+    v4l2_format fmt{};
+    bool negotiated = false;
+    for (uint32_t pf : order) {
+        fmt = v4l2_format{};
+        fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        fmt.fmt.pix.width = static_cast<uint32_t>(w);
+        fmt.fmt.pix.height = static_cast<uint32_t>(h);
+        fmt.fmt.pix.pixelformat = pf;
+        fmt.fmt.pix.field = V4L2_FIELD_NONE;
+        if (xioctl(st->fd, VIDIOC_S_FMT, &fmt) == 0 && fmt.fmt.pix.pixelformat == pf) {
+            negotiated = true;
+            break;
+        }
+    }
+    if (!negotiated) {
+        /* v4l2loopback and some bridges refuse S_FMT; take what the producer set. */
+        fmt = v4l2_format{};
+        fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        if (xioctl(st->fd, VIDIOC_G_FMT, &fmt) < 0 || !isSupportedFormat(fmt.fmt.pix.pixelformat)) {
+            std::cerr << "[v4l2] " << device << ": no supported pixel format" << std::endl;
+            return false;
+        }
+    }
+    st->pixfmt = fmt.fmt.pix.pixelformat;
+    st->width = static_cast<int>(fmt.fmt.pix.width);
+    st->height = static_cast<int>(fmt.fmt.pix.height);
+    st->bytesPerLine = static_cast<int>(fmt.fmt.pix.bytesperline);
+    if (st->bytesPerLine == 0) {
+        const int bpp = (st->pixfmt == V4L2_PIX_FMT_GREY || st->pixfmt == V4L2_PIX_FMT_NV12) ? 1
+                      : (st->pixfmt == V4L2_PIX_FMT_BGR24 || st->pixfmt == V4L2_PIX_FMT_RGB24) ? 3 : 2;
+        /* Y10/Y12/Y16 and the packed YUV formats all use two bytes per pixel. */
+        st->bytesPerLine = st->width * bpp;
+    }
+
+    if (fps > 0) {
+        v4l2_streamparm parm{};
+        parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        parm.parm.capture.timeperframe.numerator = 1;
+        parm.parm.capture.timeperframe.denominator = static_cast<uint32_t>(fps);
+        xioctl(st->fd, VIDIOC_S_PARM, &parm);
+    }
+
+    v4l2_requestbuffers req{};
+    req.count = kBufferCount;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(st->fd, VIDIOC_REQBUFS, &req) < 0 || req.count < 2) return false;
+    st->lend = req.count >= kLentBuffers + 2;
+    if (!st->lend) {
+        std::cerr << "[v4l2] " << device << ": only " << req.count << " buffers, frames are copied" << std::endl;
+    }
+
+    st->buffers.resize(req.count);
+    for (uint32_t i = 0; i < req.count; ++i) {
+        v4l2_buffer buf{};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+        if (xioctl(st->fd, VIDIOC_QUERYBUF, &buf) < 0) return false;
+        st->buffers[i].length = buf.length;
+        st->buffers[i].start = mmap(nullptr, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, st->fd, buf.m.offset);
+        if (st->buffers[i].start == MAP_FAILED) return false;
+        if (xioctl(st->fd, VIDIOC_QBUF, &buf) < 0) return false;
+    }
+
+    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(st->fd, VIDIOC_STREAMON, &type) < 0) return false;
+    st->streaming = true;
+
+    m_state = std::move(st);
+    m_device = device;
+    m_lastSeq = -1;
+    m_dropped = 0;
+    return true;
+}
+
+void V4L2Capture::close()
+{
+    if (!m_state) return;
+    m_state->streaming = false;
+    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    xioctl(m_state->fd, VIDIOC_STREAMOFF, &type);
+    m_state.reset();
+}
+
+bool V4L2Capture::isOpened() const
+{
+    return m_state && m_state->streaming;
+}
+
+bool V4L2Capture::setExposure(bool manual, double gain, int shutterUs)
+{
+    if (!isOpened()) return false;
+    const int fd = m_state->fd;
+
+    setControl(fd, V4L2_CID_AUTOGAIN, manual ? 0 : 1);
+    if (!manual) {
+        return setControl(fd, V4L2_CID_EXPOSURE_AUTO, V4L2_EXPOSURE_AUTO)
+            || setControl(fd, V4L2_CID_EXPOSURE_AUTO, V4L2_EXPOSURE_APERTURE_PRIORITY);
+    }
+    setControl(fd, V4L2_CID_EXPOSURE_AUTO, V4L2_EXPOSURE_MANUAL);
+    const bool exposure = setControl(fd, V4L2_CID_EXPOSURE_ABSOLUTE, (shutterUs + 50) / 100);
+    const bool gainSet = scaledGain(fd, V4L2_CID_ANALOGUE_GAIN, gain) || scaledGain(fd, V4L2_CID_GAIN, gain);
+    return exposure && gainSet;
+}
+
+bool V4L2Capture::read(TimedFrame& out, bool color, int timeoutMs)
+{
+    if (!isOpened()) return false;
+    State& st = *m_state;
+
+    pollfd pfd{ st.fd, POLLIN, 0 };
+    const int pr = poll(&pfd, 1, timeoutMs);
+    if (pr <= 0 || !(pfd.revents & POLLIN)) return false;
+
+    v4l2_buffer buf{};
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(st.fd, VIDIOC_DQBUF, &buf) < 0) return false;
+
+    const uint32_t index = buf.index;
+    std::shared_ptr<State> keep = m_state;
+    std::shared_ptr<void> hold(st.buffers[index].start,
+                               [keep, index](void*) { keep->requeue(index); });
+
+    if ((buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) == V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC) {
+        out.timestampNs = static_cast<int64_t>(buf.timestamp.tv_sec) * 1000000000LL
+                        + static_cast<int64_t>(buf.timestamp.tv_usec) * 1000LL;
+    } else {
+        out.timestampNs = monotonicNowNs();
+    }
+    out.seq = buf.sequence;
+    if (m_lastSeq >= 0 && out.seq > m_lastSeq + 1) m_dropped += out.seq - m_lastSeq - 1;
+    m_lastSeq = out.seq;
+
+    if (buf.flags & V4L2_BUF_FLAG_ERROR) return false;
+
+    uint8_t* data = static_cast<uint8_t*>(st.buffers[index].start);
+    const int w = st.width, h = st.height;
+    const size_t bpl = static_cast<size_t>(st.bytesPerLine);
+    bool borrowed = false;
+
+    switch (st.pixfmt) {
+        case V4L2_PIX_FMT_GREY: {
+            cv::Mat y(h, w, CV_8UC1, data, bpl);
+            if (color) cv::cvtColor(y, out.image, cv::COLOR_GRAY2BGR);
+            else { out.image = y; borrowed = true; }
+            break;
+        }
+        case V4L2_PIX_FMT_NV12: {
+            cv::Mat y(h, w, CV_8UC1, data, bpl);
+            if (color) {
+                cv::Mat uv(h / 2, w / 2, CV_8UC2, data + bpl * h, bpl);
+                cv::cvtColorTwoPlane(y, uv, out.image, cv::COLOR_YUV2BGR_NV12);
+            } else {
+                out.image = y;
+                borrowed = true;
+            }
+            break;
+        }
+        case V4L2_PIX_FMT_YUYV:
+        case V4L2_PIX_FMT_UYVY: {
+            const bool yuyv = st.pixfmt == V4L2_PIX_FMT_YUYV;
+            cv::Mat packed(h, w, CV_8UC2, data, bpl);
+            if (color) cv::cvtColor(packed, out.image, yuyv ? cv::COLOR_YUV2BGR_YUYV : cv::COLOR_YUV2BGR_UYVY);
+            else cv::extractChannel(packed, out.image, yuyv ? 0 : 1);
+            break;
+        }
+        case V4L2_PIX_FMT_BGR24: {
+            cv::Mat bgr(h, w, CV_8UC3, data, bpl);
+            if (color) { out.image = bgr; borrowed = true; }
+            else cv::cvtColor(bgr, out.image, cv::COLOR_BGR2GRAY);
+            break;
+        }
+        case V4L2_PIX_FMT_RGB24: {
+            cv::Mat rgb(h, w, CV_8UC3, data, bpl);
+            cv::cvtColor(rgb, out.image, color ? cv::COLOR_RGB2BGR : cv::COLOR_RGB2GRAY);
+            break;
+        }
+        case V4L2_PIX_FMT_Y10:
+        case V4L2_PIX_FMT_Y12:
+        case V4L2_PIX_FMT_Y16: {
+            /* MSB-align so full scale is 65535 whatever the sensor depth. */
+            const int shift = 16 - highBitDepthOf(st.pixfmt);
+            cv::Mat y(h, w, CV_16UC1, data, bpl);
+            if (color) {
+                cv::Mat aligned;
+                if (shift) y.convertTo(aligned, CV_16U, 1 << shift);
+                else aligned = y;
+                cv::cvtColor(aligned, out.image, cv::COLOR_GRAY2BGR);
+            } else if (shift) {
+                y.convertTo(out.image, CV_16U, 1 << shift);
+            } else {
+                out.image = y;
+                borrowed = true;
+            }
+            break;
+        }
+        default:
+            return false;
+    }
+
+    if (borrowed && !st.lend) {
+        out.image = out.image.clone();
+        borrowed = false;
+    }
+    if (borrowed) out.owner = std::move(hold);
+    else out.owner.reset();
+    return true;
+}
+
+#else
+
+struct V4L2Capture::State {};
+
+V4L2Capture::V4L2Capture() = default;
+V4L2Capture::~V4L2Capture() = default;
+bool V4L2Capture::available() { return false; }
+bool V4L2Capture::probe(const std::string&, std::string*, std::string*) { return false; }
+bool V4L2Capture::open(const std::string&, int, int, int, bool) { return false; }
+void V4L2Capture::close() {}
+bool V4L2Capture::isOpened() const { return false; }
+bool V4L2Capture::read(TimedFrame&, bool, int) { return false; }
+bool V4L2Capture::setExposure(bool, double, int) { return false; }
+
+#endif
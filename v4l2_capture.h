@@ -0,0 +1,53 @@
+#ifndef V4L2_CAPTURE_H
+#define V4L2_CAPTURE_H
+
+#include "frame_sync.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/* Native V4L2 streaming capture (VIDIOC_REQBUFS + mmap, poll-driven DQBUF).
+   Frames whose layout allows it (GREY, Y16, Y plane of NV12, BGR24 in
+   colour mode) are returned as cv::Mat views on the driver buffer;
+   TimedFrame::owner re-queues the buffer when the last reference is
+   dropped, so views are read-only. Enough buffers are requested to cover
+   kMaxPinnedFrames and still keep some queued; if the driver grants too
+   few, every frame is copied instead. timestampNs is the kernel buffer timestamp when the driver
+   reports CLOCK_MONOTONIC, seq is the driver sequence number, and gaps in
+   the sequence are counted as dropped frames. Works with vivid and
+   v4l2loopback as well as real sensors. With highBitDepth the Y16/Y12/Y10
+   formats are negotiated first and delivered as MSB-aligned CV_16U. */
+class V4L2Capture {
+public:
+    V4L2Capture();
+    ~V4L2Capture();
+    V4L2Capture(const V4L2Capture&) = delete;
+    V4L2Capture& operator=(const V4L2Capture&) = delete;
+
+    static bool available();
+    /* Cheap capability check without streaming: a capture+streaming node
+       offering at least one format read() understands. busInfo is stable
+       across reboots and replugs into the same port, unlike the node. */
+    static bool probe(const std::string& device, std::string* card = nullptr, std::string* busInfo = nullptr);
+
+    bool open(const std::string& device, int w, int h, int fps, bool highBitDepth = false);
+    void close();
+    bool isOpened() const;
+    bool read(TimedFrame& out, bool color, int timeoutMs = 500);
+    /* V4L2_CID_EXPOSURE_AUTO / EXPOSURE_ABSOLUTE (100 us units) and
+       ANALOGUE_GAIN or GAIN, scaled so that gain 1.0 is the driver default. */
+    bool setExposure(bool manual, double gain, int shutterUs);
+    int64_t droppedFrames() const { return m_dropped.load(std::memory_order_relaxed); }
+    const std::string& device() const { return m_device; }
+
+private:
+    struct State;
+    std::shared_ptr<State> m_state;
+    std::string m_device;
+    int64_t m_lastSeq = -1;
+    std::atomic<int64_t> m_dropped{0};
+};
+
+#endif // V4L2_CAPTURE_H
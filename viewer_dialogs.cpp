@@ -109,6 +109,13 @@ private:
     std::function<void(QPoint)> m_clickCb;
 };
 
+/* Surface grids carry one byte per sample, or two (little-endian) when the
+   payload says "bits": 16. */
+static int gridSample(const QByteArray& grid, int i, bool wide) {
+    const uchar* g = reinterpret_cast<const uchar*>(grid.constData());
+    return wide ? (g[2 * i] | (g[2 * i + 1] << 8)) : g[i];
+}
+
 QDialog* makeProfileDialog(const QJsonObject& obj, QWidget* parent) {
     const QString title  = obj.value("title").toString();
     const bool darkTheme = obj.value("dark").toBool(true);
@@ -117,6 +124,7 @@ QDialog* makeProfileDialog(const QJsonObject& obj, QWidget* parent) {
     const int bx = obj.value("bx").toInt();
     const int by = obj.value("by").toInt();
     const double length = obj.value("length").toDouble();
+    const double maxValue = obj.value("maxValue").toDouble(255.0);
 
     QJsonArray samplesArr = obj.value("samples").toArray();
     struct ProfileSample { double dist; double xPix; double yPix; double intensity; };
@@ -171,7 +179,7 @@ QDialog* makeProfileDialog(const QJsonObject& obj, QWidget* parent) {
     axX->setTitleBrush(QBrush(axisCol));
     QValueAxis* axY = new QValueAxis();
     axY->setTitleText("intensity");
-    axY->setRange(0, 255);
+    axY->setRange(0, maxValue);
     axY->setLabelsBrush(QBrush(axisCol));
     axY->setTitleBrush(QBrush(axisCol));
     chart->addAxis(axX, Qt::AlignBottom);
@@ -226,6 +234,8 @@ QDialog* makeSurfaceDialog(const QJsonObject& obj, QWidget* parent) {
     const double kBackY = obj.value("ky").toDouble(1.0);
     const int cols = obj.value("cols").toInt();
     const int rows = obj.value("rows").toInt();
+    const bool wide = obj.value("bits").toInt(8) > 8;
+    const int sampleBytes = wide ? 2 : 1;
     QByteArray gridBytes = QByteArray::fromBase64(obj.value("grid").toString().toLatin1());
 
     QDialog* w = new QDialog(parent, Qt::Window);
@@ -237,7 +247,7 @@ QDialog* makeSurfaceDialog(const QJsonObject& obj, QWidget* parent) {
     lay->setContentsMargins(8, 8, 8, 8);
     lay->setSpacing(8);
 
-    if (cols < 2 || rows < 2 || gridBytes.size() < cols * rows) {
+    if (cols < 2 || rows < 2 || gridBytes.size() < cols * rows * sampleBytes) {
         lay->addWidget(new QLabel("ROI too small or payload invalid."));
         return w;
     }
@@ -324,11 +334,10 @@ QDialog* makeSurfaceDialog(const QJsonObject& obj, QWidget* parent) {
 
     QSurfaceDataArray* data = new QSurfaceDataArray();
     data->reserve(rows);
-    const uchar* grid = reinterpret_cast<const uchar*>(gridBytes.constData());
     for (int y = 0; y < rows; ++y) {
         QSurfaceDataRow* row = new QSurfaceDataRow(cols);
         for (int x = 0; x < cols; ++x) {
-            const double z = grid[y * cols + x];
+            const double z = gridSample(gridBytes, y * cols + x, wide);
             (*row)[x].setPosition(QVector3D(float(x), float(z), float(y)));
         }
         data->append(row);
@@ -389,9 +398,9 @@ QDialog* makeSurfaceDialog(const QJsonObject& obj, QWidget* parent) {
     QObject::connect(lowColorBtn,  &QPushButton::clicked, w, [openPicker, lowColor]()  { openPicker(lowColor,  "Low color");  });
     QObject::connect(highColorBtn, &QPushButton::clicked, w, [openPicker, highColor]() { openPicker(highColor, "High color"); });
 
-    QByteArray gridCopy = gridBytes.left(rows * cols);
+    QByteArray gridCopy = gridBytes.left(rows * cols * sampleBytes);
     QObject::connect(exportDataBtn, &QPushButton::clicked, w,
-        [w, gridCopy, cols, rows, kBackX, kBackY, roiX0, roiY0, title]() {
+        [w, gridCopy, wide, cols, rows, kBackX, kBackY, roiX0, roiY0, title]() {
         const QString stamp = QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss");
         const QString suggested = QString("surface_%1_%2.csv")
             .arg(title.isEmpty() ? "view" : title).arg(stamp);
@@ -422,7 +431,6 @@ QDialog* makeSurfaceDialog(const QJsonObject& obj, QWidget* parent) {
         out << "# Grid: " << cols << " cols x " << rows << " rows\n";
         out << "# Pixel scale (source px per sample): kx=" << kBackX << ", ky=" << kBackY << "\n";
 
-        const uchar* g = reinterpret_cast<const uchar*>(gridCopy.constData());
         if (matrixForm) {
             out << "y\\x";
             for (int x = 0; x < cols; ++x) {
@@ -434,7 +442,7 @@ QDialog* makeSurfaceDialog(const QJsonObject& obj, QWidget* parent) {
                 const double sy = roiY0 + (y + 0.5) * kBackY;
                 out << sy;
                 for (int x = 0; x < cols; ++x) {
-                    out << sep << int(g[y * cols + x]);
+                    out << sep << gridSample(gridCopy, y * cols + x, wide);
                 }
                 out << "\n";
             }
@@ -444,7 +452,7 @@ QDialog* makeSurfaceDialog(const QJsonObject& obj, QWidget* parent) {
                 const double sy = roiY0 + (y + 0.5) * kBackY;
                 for (int x = 0; x < cols; ++x) {
                     const double sx = roiX0 + (x + 0.5) * kBackX;
-                    out << sx << sep << sy << sep << int(g[y * cols + x]) << "\n";
+                    out << sx << sep << sy << sep << gridSample(gridCopy, y * cols + x, wide) << "\n";
                 }
             }
         }
@@ -481,7 +489,7 @@ QDialog* makeSurfaceDialog(const QJsonObject& obj, QWidget* parent) {
     surface->axisX()->setTitleVisible(true);
     surface->axisY()->setTitleVisible(true);
     surface->axisZ()->setTitleVisible(true);
-    surface->axisY()->setRange(0.0f, 255.0f);
+    surface->axisY()->setRange(0.0f, wide ? 65535.0f : 255.0f);
     surface->addSeries(series);
     return w;
 }